@@ -1,28 +1,290 @@
+//Needed for mmap, which is part of POSIX rather than standard C
+#define _POSIX_C_SOURCE 200809L
 #include "network.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
+#include <limits.h>
+#include <math.h>
+//unistd.h is left out on purpose - its link and unlink clash with the network functions
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#endif
 
      //Constants
 const int INITIAL_EDGES = 5;
 const int INITIAL_NODES = 10;
 const double GROWTH_RATE = 1.5;
+//Must be a power of two - bucket indices are found by masking the hash
+const int INITIAL_BUCKETS = 32;
+//Nodes with more edges than this also keep a hash table of their edges
+const int HUB_EDGES = 16;
+//Bytes in each block an arena network hands its nodes and edges out of
+const size_t SLAB_SIZE = 1 << 20;
+//The number of shortest path trees each network keeps for cachedDijkstra
+const int CACHED_TREES = 4;
+//The most buckets deltaStepping keeps at once - narrower widths are widened to stay within it
+const int STEP_BUCKETS = 1 << 16;
+//Width of the square tiles allPairsShortest works on - three tiles of doubles fit in a typical L2 cache
+const int FLOYD_BLOCK = 64;
 
      //Struct definitions
+//One edge leaving a node
+//The target and weight sit side by side, so reading an edge touches one place in memory
+typedef struct edge{
+     //The inventory slot of the node the edge leads to
+     int target;
+     //Where this edge is in the target's list of parents, so that it can be removed without a search
+     int back;
+     //The 'cost' of traversing the edge
+     double weight;
+} edge;
+
 //node declared here, user has no knowledge of it
 typedef struct node{
      item x;
      int capacity;
      int links;
-     //Stores all of the edge that begin at that node
-     struct node **edge;
-     //Stores the 'cost' of traversing a particular edge
-     //Corresponds to the edge array
-          //ie: the weight of edge[0] is stored in weight[0].
-     double *weight;
+     //Stores all of the edges that begin at that node
+     edge *edge;
+     //For nodes with more than HUB_EDGES edges, an open-addressing hash table from
+     //target slot to the edge's index in the edge array, so that high-degree nodes
+     //find an edge without scanning. NULL for smaller nodes. Empty buckets hold -1.
+     int *lookup;
+     int lookupSize;
+     //Slots of the nodes that have an edge leading to this one, in no particular order
+     //Lets deleteNode visit only the nodes it has to change
+     int *parents;
+     //parentEdge[i] is the index of the edge from parents[i] in that node's edge array
+     int *parentEdge;
+     int parentCount;
+     int parentCapacity;
 } node;
 
+//Compressed sparse row copy of a network
+//The edges of node i are targets[offsets[i]] to targets[offsets[i + 1] - 1],
+//given as node numbers rather than pointers, with matching weights.
+struct frozen{
+     int size;
+     int edges;
+     item null;
+     //Node number of the root, or -1 if there is none
+     int root;
+     item *items;
+     int *offsets;
+     int *targets;
+     double *weights;
+     //Copy of the network's hash table - node numbers equal inventory slots
+     int *buckets;
+     int bucketCount;
+     //If the snapshot was loaded from a file, every array above points into this
+     //block, which is released as a whole instead of array by array
+     char *mapping;
+     size_t mappingLength;
+};
+
+//The start of a file written by saveNetwork
+//It is followed by the weights, items, offsets, targets and buckets arrays of
+//the snapshot, in that order, so that the doubles come first and stay aligned
+typedef struct fileHeader{
+     char magic[4];
+     int version;
+     //Files can only be loaded by programs using the same item type and byte order
+     int itemSize;
+     int size;
+     int edges;
+     int root;
+     int bucketCount;
+     item null;
+} fileHeader;
+
+//Binary min-heap of inventory slots, used as the priority queue in dijkstra
+//The keys are not copied - key[slot] is read from an array owned by the caller
+typedef struct heap{
+     int size;
+     //slots[0] is always the slot with the smallest key
+     int *slots;
+     //pos[slot] is where that slot sits in the slots array, or -1 if absent
+     int *pos;
+     double *key;
+} heap;
+
+//Shared by the threads of dijkstraBatch, which take the next root to run from it
+typedef struct batch{
+     const network *n;
+     const item *roots;
+     int count;
+     double *d;
+     item *p;
+     //The next root to be run, read and advanced under lock
+     int next;
+#ifndef _WIN32
+     pthread_mutex_t lock;
+#endif
+} batch;
+
+//A shorter distance to a node found by one of the deltaStepping threads, applied once they all finish
+typedef struct request{
+     int target;
+     int from;
+     double distance;
+} request;
+
+//State shared by the deltaStepping threads
+//Thread 0 is the calling thread. It sorts nodes into buckets and applies requests between phases,
+//while the others wait. In each phase every thread relaxes the edges of its share of the frontier.
+typedef struct stepper{
+     const network *n;
+     double *d;
+     item *p;
+     double delta;
+     int threads;
+     //A node is never more than maxWeight / delta buckets ahead of the one being emptied,
+     //so only that many buckets are kept, and used in a cycle
+     int **buckets;
+     int *bucketSize;
+     int *bucketCapacity;
+     int cycle;
+     //The full bucket number each node is waiting in, or -1
+     long long *bucketOf;
+     //The number of nodes waiting in a bucket
+     int pending;
+     //The nodes whose edges are relaxed in this phase, and whether it is their light or heavy edges
+     int *frontier;
+     int frontierSize;
+     bool heavy;
+     //One list of requests for each thread, so they never write to the same one
+     request **requests;
+     int *requestCount;
+     int *requestCapacity;
+#ifndef _WIN32
+     //A barrier - made from a mutex and condition as macOS has no pthread_barrier_t
+     pthread_mutex_t lock;
+     pthread_cond_t wake;
+     int arrived;
+     int generation;
+     //The number of threads started so far, which gives each its number
+     int started;
+#endif
+     //Set by thread 0 when there are no phases left
+     bool done;
+} stepper;
+
+//The distance matrix being worked on by allPairsShortest, shared by its threads
+//Row i of dist holds the distances from slot i, with INFINITY for no path yet
+typedef struct tiling{
+     double *dist;
+     //The slot of the second node on each path, or NULL if the paths aren't wanted
+     int *next;
+     int size;
+     int blocks;
+     //The tile on the diagonal for this round, and whether the round is at phase 2 or 3
+     int k;
+     int phase;
+     //The next tile of the phase to be worked on, read and advanced under lock
+     int job;
+     int jobs;
+#ifndef _WIN32
+     pthread_mutex_t lock;
+#endif
+} tiling;
+
+//A place in the order findSubNets matches pattern nodes in, and where its candidates come from
+typedef struct matchStep{
+     //The pattern slot matched at this step
+     int slot;
+     //The step of an earlier node joined to this one by an edge, or -1 if there is none.
+     //Candidates are then that node's match's edges, or parents if fromParent is true,
+     //rather than every node of the host.
+     int anchor;
+     bool fromParent;
+} matchStep;
+
+//First-in first-out queue of inventory slots, stored as a ring buffer
+//head is the next slot to leave, tail is where the next slot will be added
+typedef struct queue{
+     int capacity;
+     int head;
+     int tail;
+     int count;
+     int *slots;
+} queue;
+
+//Reads network text one character at a time, from memory or from a file in chunks
+//Nothing is copied except the file chunk and the start of the current term
+typedef struct parser{
+     //NULL when reading from memory
+     FILE *file;
+     //The characters not yet read are text[pos] to text[length - 1]
+     const char *text;
+     size_t length;
+     size_t pos;
+     char chunk[4096];
+     //The current term so far, kept only for error messages
+     char term[64];
+     int termLength;
+} parser;
+
+//One block of memory in an arena network
+//Nodes and edge arrays are cut from data in order, and never freed on their own
+typedef struct slab{
+     struct slab *next;
+     size_t used;
+     size_t size;
+     //Aligned for the doubles and pointers stored in it
+     double data[];
+} slab;
+
+//The result of one run of dijkstra kept by a network, for cachedDijkstra
+//It is only used while version matches the network's - any change to the network makes it stale
+typedef struct cachedTree{
+     item root;
+     unsigned long version;
+     //NULL until the entry is first used
+     double *d;
+     item *p;
+     //The number of nodes d and p have room for
+     int capacity;
+} cachedTree;
+
+//Shortest paths from one root that are kept up to date as the network changes - see trackShortestPaths
+//Arrays are indexed by inventory slot and have room for capacity nodes
+typedef struct tracker{
+     //Slot of the root, or -1 once it has been deleted
+     int root;
+     double *d;
+     //Slot of the node before each one on its shortest path, or -1
+     int *prev;
+     //The items of the nodes in prev, or the null value - given out by trackedPaths
+     item *p;
+     int capacity;
+     //Holds the nodes whose distances have dropped but whose edges have not been followed yet
+     //Always empty between changes to the network
+     heap *h;
+     //The nodes cut off by the last change, waiting to be given a distance again
+     int *lost;
+     int lostCount;
+} tracker;
+
+//Arrays reused by shortestPath, bidirectionalPath and astar, so that a search only costs what it reaches
+//Indexed by inventory slot with room for capacity nodes. Between searches every distance is -1
+//and both heaps are empty, so each search only has to clear the slots it reached afterwards.
+typedef struct searcher{
+     //d[0] and prev[0] search forwards from the source, d[1] and prev[1] backwards from the target
+     double *d[2];
+     int *prev[2];
+     //The heap keys of astar
+     double *f;
+     heap *h[2];
+     //Every slot given a distance by the current search
+     int *touched;
+     int touchedCount;
+     int capacity;
+} searcher;
+
 //network, while not defined here, is opaque to the user - its attributes are hidden
 typedef struct network{
      int size;
@@ -37,6 +299,24 @@ typedef struct network{
      node *root;
      //Stores a pointer to every node in the network for ease of searching
      node **inventory;
+     //Open-addressing hash table mapping each item to its slot in inventory
+     //Empty buckets hold -1. Kept at most half full so probes stay short.
+     int *buckets;
+     int bucketCount;
+     //The newest slab of an arena network, linked to the older ones
+     //NULL for networks whose nodes are each allocated with malloc
+     slab *slabs;
+     bool arena;
+     //Counts changes to the nodes and edges, so that cached results can tell they are out of date
+     unsigned long version;
+     //CACHED_TREES shortest path trees, or NULL until cachedDijkstra is first called
+     cachedTree *cache;
+     //The entry to be replaced next - the one computed longest ago
+     int cacheNext;
+     //NULL unless trackShortestPaths has been called
+     tracker *tracked;
+     //NULL until one of the point to point searches is first run
+     searcher *search;
 } network;
 
 //Private function declarations
@@ -44,183 +324,441 @@ typedef struct network{
 //   MEMORY HANDLING
 
 //Frees memory allocated to a node
-void freeNode(node *n);
+//Nodes in an arena network are left for freeNetwork to release with their slab
+void freeNode(network *n, node *v);
+
+//Returns bytes bytes of memory for the network n to use for nodes and edges
+//Arena networks take it from the current slab, starting a new one when it is full
+void *allocate(network *n, size_t bytes);
+
+//Gives v room for capacity edges, keeping the ones it already has
+void growEdges(network *n, node *v, int capacity);
 //Frees memory allocated to a network and all of its nodes
 void freeNetwork(network *n);
 
 //   STRING HANDLING
 
-//Returns all of a string starting from i before the separator character appears
-//i passed as a pointer, as it then will become the index of the char after the separator
-char *sliceTerm(char *s, int *i, char separator);
+//Sets up a parser over length characters of text, or over the file f if text is NULL
+void newParser(parser *ps, const char *text, size_t length, FILE *f);
+
+//Returns the next character without consuming it, reading another chunk of the file if needed
+//EOF is returned at the end of the input
+int peekChar(parser *ps);
 
-//Checks if a value is a valid integer or floating point number (floating = false for integers)
-//Checks from i until the terminator character reached or end of string
-//Only non-numerical char (0-9) allowed is '.', only if value is floating point
-//Not allowed to end on the terminator value - 'x-' and 'x-y/' are invalid, for example
-bool checkValue(char *s, int *i, char terminator, bool floating);
+//Consumes and returns the next character, adding it to the current term
+int nextChar(parser *ps);
 
-//Makes sure the term entered is valid. Acceptable syntaxes are:
+//Returns true if c ends a term - a ',', a line break or the end of the input
+bool isSeparator(int c);
+
+//Reads a whole number into x. False is returned if there are no digits, or it is too large.
+bool parseItem(parser *ps, item *x);
+
+//Reads a number of digits with at most one '.' into w
+//The characters are gathered into a small buffer on the stack and converted with strtod
+bool parseWeight(parser *ps, double *w);
+
+//Reads one term and the separator after it. Acceptable syntaxes are:
      //x-y/w   - where x has an edge to y with weight w.
      //x-y     - where x has an edge to y with default weight 1
      //x       - where x is a node with no edges
-bool checkTerm(char *s);
+//hasEdge is set to whether the term has a y value. An empty term is valid, and leaves x as it was.
+//If the term is invalid, the rest of it is skipped and false is returned.
+bool parseTerm(parser *ps, item *x, item *y, double *w, bool *hasEdge);
 
-//Used to reduce repetition in getValues
-//Gets a substring of s from i to the limit (or end of string) character
-//Converts value found using passed specifier, stores in x
-void readValue(char *s, void *x, int *i, char limit, char *specifier);
-
-//Parses the values of x, y, and w from string s
-bool getValues(char *s, item *x, item *y, double *w, item n);
+//Makes sure the string s is exactly one valid term
+bool checkTerm(char *s);
 
-//Adds the nodes and edges in the term to the network.
+//Adds x, and if hasEdge is true y with an edge from x of weight w, to the network
+//Nothing is added if either value is the null value
 //If some of the nodes and edges already exist, the addition of them is ignored
      //This uses the existing checking of the header-defined functions.
-void addTerm(network *n, char *s);
-
-//   SUPPORTING FUNCTIONS
-
-//Gets the address of the node containing the item x
-//If x is not in the network, NULL is returned
-node *find(network *n, item x);
+void addValues(network *n, item x, item y, double w, bool hasEdge);
 
-//Swaps the values of elements arr[i] and arr[j]
-void swap(int i, int j, node **arr);
+//Adds the nodes and edges in the term to the network.
+void addTerm(network *n, char *s);
 
-//Selection sort algorithm - size not expected to be huge so O(n^2) acceptable for gained simplicity
-//Used for 'neatness' when printing networks
-void sort(int size, node **arr);
+//Builds a network from every term the parser reads
+//If a term is invalid, valid is set to false and NULL is returned, leaving the term in ps->term.
+//Nothing is printed - the public functions report the error with printTermError.
+network *parseNetwork(parser *ps, item d, bool *valid);
 
-//Removes the specified item from the array,
-//then shifts all items above it down to fill the gap
-bool deleteFromArr(int len, node **arr, item x);
-//Removes the weight in the specified index from the array,
-//then shifts all items above it down to fill the gap
-bool deleteWeight(int len, double *arr, int index);
+//Prints the invalid term the parser stopped at, and the syntax terms should have
+void printTermError(parser *ps);
 
-//Returns true if the passed list of node pointers points to a node with the value x.
-bool contains(int len, node **arr, item x);
+//   SUPPORTING FUNCTIONS
 
-//Returns the index of the node with the value x in the array of nodes
-//If no node contains x, -1 is returned
-int getIndex(int len, node **arr, item x);
+//Creates a node holding x with room for capacity edges
+node *newNode(network *n, item x, int capacity);
 
-//   RECURSION FUNCTIONS
+//Adds the node v to the end of the inventory and the hash table
+//If v is the first node, it becomes the root
+void appendNode(network *n, node *v);
 
-//Checks if a node has already been visited, then recurses into its child nodes
-//Acts in a depth-first style
-bool isNodeCyclic(node *n, int k, item visited[]);
+//Grows the inventory and hash table so that count nodes fit without resizing
+void reserveNodes(network *n, int count);
 
-//Checks the current node, then recurses into each child node
-//The whole subtree of each child node is searched before the next one is
-node *depthSearchNode(node *n, item x, int k, item visited[]);
+//Gets the address of the node containing the item x
+//If x is not in the network, NULL is returned
+node *find(network *n, item x);
 
-//In a depth-first style, recurses into each of its child nodes
-//The largest result of the recursion is returned, + 1
-int depthNode(node *current);
+//Returns the bucket that the item x hashes to in a table of size count
+int hashItem(item x, int count);
 
-//Uses a depth first approach - calculates the depth to the child, then recurses into it
-//If a depth found is shorter than the currently stored one, it is replaced by the new one
-void dijkstraNode(network *n, node *current, double *d, item *p, int k, item visited[]);
+//Returns the inventory slot of the node containing x, using the hash table
+//If no node contains x, -1 is returned
+int getSlot(const network *n, item x);
+
+//Records that the node in inventory[slot] can be found at that slot
+//If its item is already in the table, the stored slot is overwritten
+void indexSlot(network *n, int slot);
+
+//Removes the item x from the hash table
+//Later entries in the same run of buckets are shifted back to fill the gap
+void unindexItem(network *n, item x);
+
+//Empties the hash table and re-adds every node in the inventory
+//Used after the inventory is reordered
+void rebuildIndex(network *n);
+
+//Orders two nodes by their items, for qsort
+int compareNodes(const void *a, const void *b);
+
+//Sorts the inventory, then updates the hash table and every edge to the new slots
+//Used for 'neatness' when printing networks. Does nothing if the inventory is already sorted,
+//so printing a network more than once only pays for the sort the first time.
+void sortInventory(network *n);
+
+//Returns the index in v's edge array of the edge leading to the node in the given slot
+//If v has no such edge, -1 is returned
+int findEdge(node *v, int slot);
+
+//Returns the index in the current node's edge array of the edge leading to y
+//If y is not in the network, or the current node has no edge to it, -1 is returned
+int findEdgeTo(network *n, item y);
+
+//Adds an edge from the node in slot from to the node in slot to, growing arrays if needed
+void addEdge(network *n, int from, int to, double w);
+
+//Removes edge i from the node in slot from, keeping the order of the rest
+void removeEdge(network *n, int from, int i);
+
+//Removes edge i of v by moving its last edge into the gap, leaving the target's list of parents alone
+//Only used by deleteNode, where keeping the order would make each removal cost v's out-degree
+void dropEdge(network *n, node *v, int i);
+
+//Changes the target of edge i of v to the given slot
+void retarget(node *v, int i, int slot);
+
+//Add or remove the entry for edge i of v in v's edge hash table, if it has one
+void lookupInsert(node *v, int i);
+void lookupRemove(node *v, int i);
+
+//Records that edge i of the node in the given slot leads to v
+void addParent(network *n, node *v, int slot, int i);
+//Removes entry i of v's list of parents, moving its last entry into the gap
+void removeParent(network *n, node *v, int i);
+//Recreates every node's list of parents from the edges
+void rebuildParents(network *n);
+
+//Rebuilds v's edge hash table after its edges have changed
+//The table is created once v has more than HUB_EDGES edges, and dropped if it falls back below
+void indexEdges(network *n, node *v);
+
+//   PRIORITY QUEUE
+
+//Creates an empty heap able to hold slots 0 to capacity - 1, ordered by key
+heap *newHeap(int capacity, double *key);
+void freeHeap(heap *h);
+bool heapEmpty(heap *h);
+//Adds a slot to the heap - key[slot] must already be set
+void heapPush(heap *h, int slot);
+//Restores the heap order after key[slot] has been lowered
+void heapDecrease(heap *h, int slot);
+//Removes and returns the slot with the smallest key
+int heapPop(heap *h);
+//Move the slot at heap position i towards the top or bottom until it is in order
+void siftUp(heap *h, int i);
+void siftDown(heap *h, int i);
+
+//Runs dijkstra from the node in the given slot, or gives every node -1 if root is -1
+//h must be empty and able to hold every slot - it is left empty for the next run
+void runDijkstra(const network *n, int root, double *d, item *p, heap *h);
+
+//Writes the items on the path that ends at slot into path, first to last, following prev back to -1
+//Returns the number of items written
+int tracePath(const network *n, const int *prev, int slot, item *path);
+
+//Makes sure n->search exists and has room for every node in n, then returns it
+searcher *searchReserve(network *n);
+//Gives back the distances and heap positions of the slots reached by the last search
+void searchReset(searcher *s);
+void freeSearcher(searcher *s);
+
+//Moves side 0 or side 1 of bidirectionalPath forward by one node
+//Side 0 follows edges forwards, and side 1 follows them backwards using the parents of each node.
+//best and meet are updated when this side reaches a node the other side has already reached.
+void searchStep(const network *n, searcher *s, int side, double *best, int *meet);
+
+//Returns the cache entry holding the results for root, running dijkstra into the oldest entry if none does
+cachedTree *cacheLookup(network *n, item root);
+
+//Runs roots from b until none are left, reusing one heap - the body of each dijkstraBatch thread
+void *batchWorker(void *b);
+
+//   DELTA STEPPING
+
+//Relaxes the light or heavy edges of frontier[start] to frontier[end - 1], adding requests to thread t's list
+void stepRelax(stepper *s, int t, int start, int end);
+//Runs a phase over the whole frontier, shared between the threads
+void stepPhase(stepper *s);
+//Applies the requests of every thread in thread order, moving nodes to their new buckets
+void stepApply(stepper *s, long long current);
+//Moves the node in slot v to the given bucket
+void stepBucket(stepper *s, int v, long long bucket);
+//Waits until every thread of s has called it
+void stepWait(stepper *s);
+//The body of each deltaStepping thread besides the calling one
+void *stepWorker(void *s);
+
+//   DYNAMIC SHORTEST PATHS
+
+//Makes sure the arrays of n->tracked have room for every node in n
+void trackReserve(network *n);
+//Called when the edge from slot u to slot v is added or lowered to weight w
+//If it gives v a shorter path, the change is passed on through the heap to every node it improves
+void trackLower(network *n, int u, int v, double w);
+//Takes nodes off the heap until it is empty, following their edges to any nodes they now reach sooner
+void trackSpread(network *n);
+//Marks v and every node whose shortest path goes through it as unreachable, adding them to the lost list
+void trackCut(network *n, int v);
+//Gives each lost node the best distance through its parents that were not lost, then spreads from them
+void trackRepair(network *n);
+//Called by deleteNode once the node in slot index is gone and the last node has moved into its slot
+void trackRemove(network *n, int index, int last);
+//Called by sortInventory - moved[i] is the new slot of the node that was in slot i
+void trackPermute(network *n, const int *moved);
+
+//   ALL PAIRS
+
+//Shortens the paths in tile (ib, jb) with the nodes in tile kb as the middle step
+//Works for any three tiles, including when they are the same, as no weight is negative
+void floydTile(tiling *t, int ib, int jb, int kb);
+//Takes tiles of the current phase until there are none left - the body of each allPairsShortest thread
+void *floydWorker(void *t);
+//Runs every tile of the current phase over up to the given number of threads
+void floydPhase(tiling *t, int threads);
+
+//   MATCHING
+
+//Puts the nodes of pattern in the order findSubNets matches them: the node with the most edges first,
+//then each time the node with the most edges to nodes already placed, so that mismatches are found early
+void orderPattern(const network *pattern, matchStep *steps);
+//Returns true if the host node h can be matched to the pattern node u, given the matches of
+//every node before it in the order. map[v] is the host slot matched to pattern slot v, or -1.
+bool canMatch(const network *host, const network *pattern, int u, int h, const int *map);
+
+//   QUEUE
+
+//Creates an empty queue able to hold up to capacity slots at once
+queue *newQueue(int capacity);
+void freeQueue(queue *q);
+bool queueEmpty(queue *q);
+//Adds a slot to the back of the queue - the queue must not be full
+void enqueue(queue *q, int slot);
+//Removes and returns the slot at the front of the queue
+int dequeue(queue *q);
+
+//   TRAVERSAL FUNCTIONS
+
+//Returns the number of levels in the network if it is a tree rooted at n->root, or -1 if not
+//The number of parents of each node is checked in one pass, then one walk from the root
+//checks that every node is reached. An empty network has 0 levels.
+int treeDepth(network *n);
+
+//Kahn's algorithm - writes the slots of n into order one level at a time, where a level is every
+//node whose parents are all in earlier levels. If levelStart is not NULL, levelStart[k] is set to
+//where level k starts in order, and the entry after the last level to nodes(n).
+//Returns the number of levels, or -1 if n has a cycle.
+int orderLevels(const network *n, int *order, int *levelStart);
+
+//Visits every node reachable from the root in breadth-first order, stopping early at x
+//If out is not NULL, the items of the visited nodes are written to it in order
+//and count is set to how many were written
+//Returns the node containing x, or NULL if it was not reached
+node *breadthWalk(network *n, item x, item *out, int *count);
+
+//   FROZEN NETWORKS
+
+//Returns the node number of x in the snapshot, or -1 if it is not there
+int frozenSlot(frozen *f, item x);
+
+//Returns true if node u of the snapshot has an edge to node v
+bool frozenContains(frozen *f, int u, int v);
+
+//   FILES
+
+//Finds where each array starts in a file with header h
+//sections is given the offsets of the weights, items, offsets, targets and buckets arrays
+//Returns the total length of the file
+size_t fileLayout(fileHeader *h, size_t sections[5]);
+
+//Maps the whole file at path into memory, read only, and sets length to its size
+//On systems without mmap, the file is read into one allocated block instead
+//Returns NULL if the file can't be opened
+char *mapFile(const char *path, size_t *length);
+void unmapFile(char *mapping, size_t length);
+
+//Checks every array of a snapshot loaded from a file, so that the frozen functions can trust them
+//Offsets must start at 0, never decrease and end at the number of edges. Targets must be nodes,
+//weights must not be negative, and the buckets must hold nodes or -1, with at least one -1.
+bool checkFrozen(frozen *f);
 
 //   PRINTING FUNCITONS
 
 //Prints the list for the passed node in an adjacency list
-void printNodeList(node *n);
+void printNodeList(network *n, node *current);
 //Prints a row of an adjacency matrix - all of the nodes that current has edges to
 void printNodeMatrix(network *n, node *current);
 
 //Function definitions
 
-char *sliceTerm(char *s, int *i, char separator){
-     int len = 0;
-     for(int j = *i; s[j] != separator && s[j] != 0; j++){
-          len++;
-     }
-     int j = *i;
-     *i += len + 1;
-     char *substring = malloc((len + 1) * sizeof(char));
+void newParser(parser *ps, const char *text, size_t length, FILE *f){
+     ps->file = f;
+     ps->text = text;
+     ps->length = (text == NULL) ? 0 : length;
+     ps->pos = 0;
+     ps->termLength = 0;
+}
 
-     for(int k = 0; k < len; k++){
-          substring[k] = s[k + j];
+int peekChar(parser *ps){
+     if(ps->pos == ps->length){
+          if(ps->file == NULL) return EOF;
+          ps->length = fread(ps->chunk, 1, sizeof(ps->chunk), ps->file);
+          ps->text = ps->chunk;
+          ps->pos = 0;
+          if(ps->length == 0) return EOF;
      }
-     substring[len] = 0;
+     return (unsigned char)ps->text[ps->pos];
+}
 
-     return substring;
+int nextChar(parser *ps){
+     int c = peekChar(ps);
+     if(c == EOF) return EOF;
+     ps->pos++;
+     if(ps->termLength < (int)sizeof(ps->term) - 1) { ps->term[ps->termLength++] = c; }
+     return c;
 }
 
-bool checkValue(char *s, int *i, char terminator, bool floating){
-     int len = strlen(s);
-     while(s[*i] != terminator && s[*i] != 0){
-          //If it's a number
-          if(s[*i] > '9' || s[*i] < '0'){
-               //If not a floating point number, will always return false
-               //If a floating point number not equal to '.', return false
-               if((floating && s[*i] == '.') == false) return false;
-          }
-          *i += 1;
+bool isSeparator(int c){
+     return c == ',' || c == '\n' || c == '\r' || c == EOF;
+}
+
+bool parseItem(parser *ps, item *x){
+     long long value = 0;
+     int digits = 0;
+     while(peekChar(ps) >= '0' && peekChar(ps) <= '9'){
+          value = value * 10 + (nextChar(ps) - '0');
+          if(value > INT_MAX) return false;
+          digits++;
      }
-     if(s[*i] == terminator && *i == len - 1) return false;
+     if(digits == 0) return false;
+     *x = value;
      return true;
 }
 
-bool checkTerm(char *s){
-     int i = 0;
-     //Checks the first value
-     if(!checkValue(s, &i, '-', false)) return false;
-     if(s[i] == 0) return true;
-     i++;
-
-     //Check second value
-     if(!checkValue(s, &i, '/', false)) return false;
-     if(s[i] == 0) return true;
-     i++;
-
-     //Check weight
-     if(!checkValue(s, &i, '\0', true)) return false;
+bool parseWeight(parser *ps, double *w){
+     char digits[64];
+     int len = 0, points = 0;
+     int c = peekChar(ps);
+     while((c >= '0' && c <= '9') || c == '.'){
+          if(c == '.') points++;
+          if(points > 1 || len == (int)sizeof(digits) - 1) return false;
+          digits[len++] = nextChar(ps);
+          c = peekChar(ps);
+     }
+     digits[len] = 0;
+     if(len == points) return false;
+     *w = strtod(digits, NULL);
      return true;
 }
 
-void readValue(char *s, void *x, int *i, char limit, char *specifier){
-     //Get substring
-     char *X = sliceTerm(s, i, limit);
-     //Convert to numerical type
-     sscanf(X, specifier, x);
-     free(X);
+bool parseTerm(parser *ps, item *x, item *y, double *w, bool *hasEdge){
+     ps->termLength = 0;
+     *hasEdge = false;
+     bool valid = true;
+     if(!isSeparator(peekChar(ps))){
+          valid = parseItem(ps, x);
+          if(valid && peekChar(ps) == '-'){
+               nextChar(ps);
+               *hasEdge = true;
+               valid = parseItem(ps, y);
+               if(valid && peekChar(ps) == '/'){
+                    nextChar(ps);
+                    valid = parseWeight(ps, w);
+               }
+          }
+          //Anything left over, such as the '/3' in '1/3', makes the term invalid
+          if(!isSeparator(peekChar(ps))) valid = false;
+     }
+     //Skip to the end of the term, then past the separator
+     while(!isSeparator(peekChar(ps))) { nextChar(ps); }
+     ps->term[ps->termLength] = 0;
+     if(peekChar(ps) != EOF) ps->pos++;
+     return valid;
 }
 
-bool getValues(char *s, item *x, item *y, double *w, item n){
-     int i = 0;
-     int len = strlen(s);
-
-     //Read in 'x' node, need an integer
-     readValue(s, (void*)x, &i, '-', "%d");
-     if(*x == n) return false;
-     if(i >= len) return true;
-
-     //Read in 'y' node
-     readValue(s, (void*)y, &i, '/', "%d");
-     if(*y == n) return false;
-     if(i >= len) return true;
-
-     //Weight is floating, so %lf used
-     readValue(s, (void*)w, &i, '\0', "%lf");
-     return true;
+bool checkTerm(char *s){
+     parser ps;
+     newParser(&ps, s, strlen(s), NULL);
+     item x = 0, y = 0; double w = 1; bool hasEdge;
+     if(!parseTerm(&ps, &x, &y, &w, &hasEdge)) return false;
+     //The whole string must be the one term
+     return peekChar(&ps) == EOF && ps.pos == ps.length;
 }
 
-void addTerm(network *n, char *s){
-     item x = n->null, y = n->null; double w = 1;
-
-     bool isValid = getValues(s, &x, &y, &w, n->null);
-     if(isValid == false) return;
-
+void addValues(network *n, item x, item y, double w, bool hasEdge){
+     if(x == n->null) return;
+     if(hasEdge && y == n->null) return;
      addNode(n, x);
+     n->current = find(n, x);
+     if(!hasEdge) return;
      addNode(n, y);
      n->current = find(n, x);
      link(n, y, w);
 }
 
+void addTerm(network *n, char *s){
+     parser ps;
+     newParser(&ps, s, strlen(s), NULL);
+     item x = n->null, y = n->null; double w = 1; bool hasEdge;
+     if(parseTerm(&ps, &x, &y, &w, &hasEdge)) addValues(n, x, y, w, hasEdge);
+}
+
+network *parseNetwork(parser *ps, item d, bool *valid){
+     network *n = newNetwork(d);
+     *valid = true;
+     while(peekChar(ps) != EOF){
+          item x = d, y = d; double w = 1; bool hasEdge;
+          if(parseTerm(ps, &x, &y, &w, &hasEdge) == false){
+               *valid = false;
+               freeNetwork(n);
+               return NULL;
+          }
+          addValues(n, x, y, w, hasEdge);
+     }
+     if(n->root == NULL) { freeNetwork(n); return NULL; }
+     reset(n);
+     return n;
+}
+
+void printTermError(parser *ps){
+     fprintf(stderr, "%s is not a valid term.\nUse:\n   %s   %s   %s", ps->term,
+               "x-y/w where x has an edge to y with weight w.\n",
+               "x-y where x has an edge to y with weight 1.\n",
+               "x where x has no edges.\n");
+}
+
 network *newNetwork(item d){
      network *n = malloc(sizeof(network));
      n->null = d;
@@ -229,30 +767,51 @@ network *newNetwork(item d){
      n->size = 0;
      n->capacity = INITIAL_NODES;
      n->inventory = malloc(INITIAL_NODES * sizeof(node*));
+     n->bucketCount = INITIAL_BUCKETS;
+     n->buckets = malloc(INITIAL_BUCKETS * sizeof(int));
+     for(int i = 0; i < INITIAL_BUCKETS; i++) { n->buckets[i] = -1; }
+     n->slabs = NULL;
+     n->arena = false;
+     n->version = 0;
+     n->cache = NULL;
+     n->cacheNext = 0;
+     n->tracked = NULL;
+     n->search = NULL;
      return n;
 }
 
-network *newNetworkFromString(char *s, item d){
+network *newNetworkArena(item d){
      network *n = newNetwork(d);
-     int i = 0, len = strlen(s);
-     item r = d;
-     while(i < len){
-          char *term = sliceTerm(s, &i, ',');
-          if(checkTerm(term) == false){
-               fprintf(stderr, "%s is not a valid term.\nUse:\n   %s   %s   %s", term,
-                         "x-y/w where x has an edge to y with weight w.\n",
-                         "x-y where x has an edge to y with weight 1.\n",
-                         "x where x has no edges.\n");
-               free(term);
-               exit(1);
-          }
-          addTerm(n, term);
-          if(getRoot(n) == n->null) { r = get(n); setRoot(n, r); }
-          free(term);
-     }
-     if(n->root != NULL) { reset(n); }
-     else { freeNetwork(n); return NULL; }
-     sort(n->size, n->inventory);
+     n->arena = true;
+     return n;
+}
+
+network *newNetworkFromString(char *s, item d){
+     parser ps;
+     newParser(&ps, s, strlen(s), NULL);
+     bool valid;
+     network *n = parseNetwork(&ps, d, &valid);
+     if(!valid) { printTermError(&ps); exit(1); }
+     if(n == NULL) return NULL;
+     sortInventory(n);
+     return n;
+}
+
+network *newNetworkFromBuffer(const char *s, size_t length, item d){
+     parser ps;
+     newParser(&ps, s, length, NULL);
+     bool valid;
+     network *n = parseNetwork(&ps, d, &valid);
+     if(!valid) printTermError(&ps);
+     return n;
+}
+
+network *newNetworkFromFile(FILE *f, item d){
+     parser ps;
+     newParser(&ps, NULL, 0, f);
+     bool valid;
+     network *n = parseNetwork(&ps, d, &valid);
+     if(!valid) printTermError(&ps);
      return n;
 }
 
@@ -267,39 +826,204 @@ bool addNode(network *n, item x){
      if(x == n->null) return false;
 
      //Define new node
-     node *v = malloc(sizeof(node));
-     v->x = x;
-     v->capacity = INITIAL_EDGES;
-     v->edge = malloc(INITIAL_EDGES * sizeof(node*));
-     v->weight = malloc(INITIAL_EDGES * sizeof(double));
-     v->links = 0;
+     node *v = newNode(n, x, INITIAL_EDGES);
 
      //Update network to point to new node
      n->current = v;
+     appendNode(n, v);
+     n->version++;
+     if(n->tracked != NULL){
+          //A new node has no edges yet, so nothing reaches it
+          trackReserve(n);
+          int slot = n->size - 1;
+          n->tracked->d[slot] = -1;
+          n->tracked->prev[slot] = -1;
+          n->tracked->p[slot] = n->null;
+     }
+
+     return true;
+}
+
+node *newNode(network *n, item x, int capacity){
+     node *v = allocate(n, sizeof(node));
+     v->x = x;
+     v->capacity = 0;
+     v->links = 0;
+     v->edge = NULL;
+     v->lookup = NULL;
+     v->lookupSize = 0;
+     v->parents = NULL;
+     v->parentEdge = NULL;
+     v->parentCount = 0;
+     v->parentCapacity = 0;
+     if(capacity > 0) growEdges(n, v, capacity);
+     return v;
+}
+
+void *allocate(network *n, size_t bytes){
+     if(!n->arena) return malloc(bytes);
+     //Round up so everything handed out stays aligned for doubles and pointers
+     bytes = (bytes + sizeof(double) - 1) / sizeof(double) * sizeof(double);
+     if(n->slabs == NULL || n->slabs->used + bytes > n->slabs->size){
+          size_t size = bytes > SLAB_SIZE ? bytes : SLAB_SIZE;
+          slab *b = malloc(sizeof(slab) + size);
+          b->next = n->slabs;
+          b->used = 0;
+          b->size = size;
+          n->slabs = b;
+     }
+     void *p = (char*)n->slabs->data + n->slabs->used;
+     n->slabs->used += bytes;
+     return p;
+}
+
+void growEdges(network *n, node *v, int capacity){
+     if(!n->arena){
+          v->edge = realloc(v->edge, capacity * sizeof(edge));
+     }
+     else{
+          //The old array stays in its slab - growth is geometric, so at most half is wasted
+          edge *edges = allocate(n, capacity * sizeof(edge));
+          if(v->links > 0) memcpy(edges, v->edge, v->links * sizeof(edge));
+          v->edge = edges;
+     }
+     v->capacity = capacity;
+}
+
+void appendNode(network *n, node *v){
      if(n->size == 0) n->root = v;
      if(n->size == n->capacity){
-          n->capacity *= GROWTH_RATE;
+          n->capacity = n->capacity * GROWTH_RATE + 1;
           n->inventory = realloc(n->inventory, n->capacity * sizeof(node*));
      }
      n->inventory[n->size] = v;
      n->size = n->size + 1;
+     indexSlot(n, n->size - 1);
+}
 
-     return true;
+void reserveNodes(network *n, int count){
+     if(count > n->capacity){
+          n->capacity = count;
+          n->inventory = realloc(n->inventory, n->capacity * sizeof(node*));
+     }
+     int buckets = n->bucketCount;
+     while(buckets < 2 * count) { buckets *= 2; }
+     if(buckets != n->bucketCount){
+          free(n->buckets);
+          n->bucketCount = buckets;
+          n->buckets = malloc(buckets * sizeof(int));
+          rebuildIndex(n);
+     }
+}
+
+network *newNetworkFromEdges(const item *src, const item *dst, const double *w, size_t m, item null){
+     network *n = newNetwork(null);
+     //Guess at one node per eight edges, since most networks have several edges per node
+     //The inventory and hash table still grow as usual if there are more
+     size_t guess = m / 8;
+     reserveNodes(n, guess < (size_t)1 << 24 ? (int)guess : 1 << 24);
+
+     //Pass 1: create every node, remembering the slots at each end of each edge
+     //Edges with a null end or a negative weight are skipped, as in link, by giving them slot -1
+     int *from = malloc((m + 1) * sizeof(int));
+     int *to = malloc((m + 1) * sizeof(int));
+     for(size_t e = 0; e < m; e++){
+          from[e] = -1; to[e] = -1;
+          if(src[e] == null || dst[e] == null) continue;
+          if(w != NULL && w[e] < 0) continue;
+          int u = getSlot(n, src[e]);
+          if(u == -1) { appendNode(n, newNode(n, src[e], 0)); u = n->size - 1; }
+          int v = getSlot(n, dst[e]);
+          if(v == -1) { appendNode(n, newNode(n, dst[e], 0)); v = n->size - 1; }
+          from[e] = u; to[e] = v;
+     }
+     if(empty(n)){
+          free(from); free(to);
+          freeNetwork(n);
+          return NULL;
+     }
+
+     //Group the edges by their source with a counting sort, keeping input order within a group
+     int *start = calloc(n->size + 1, sizeof(int));
+     for(size_t e = 0; e < m; e++){
+          if(from[e] != -1) start[from[e] + 1]++;
+     }
+     for(int i = 0; i < n->size; i++) { start[i + 1] += start[i]; }
+     int *order = malloc((start[n->size] + 1) * sizeof(int));
+     int *fill = malloc((n->size + 1) * sizeof(int));
+     for(int i = 0; i < n->size; i++) { fill[i] = start[i]; }
+     for(size_t e = 0; e < m; e++){
+          if(from[e] != -1) order[fill[from[e]]++] = e;
+     }
+
+     //Pass 2: give each node one array of the exact size it needs
+     //seen[v] == u marks that u already has an edge to v, so repeats keep the first weight
+     int *seen = fill;
+     for(int i = 0; i < n->size; i++) { seen[i] = -1; }
+     for(int u = 0; u < n->size; u++){
+          int links = 0;
+          for(int k = start[u]; k < start[u + 1]; k++){
+               int e = order[k];
+               if(seen[to[e]] != u) { seen[to[e]] = u; order[start[u] + links] = e; links++; }
+          }
+          node *v = n->inventory[u];
+          if(links > 0) growEdges(n, v, links);
+          v->links = links;
+          for(int k = 0; k < links; k++){
+               int e = order[start[u] + k];
+               v->edge[k].target = to[e];
+               v->edge[k].weight = (w == NULL) ? 1 : w[e];
+          }
+          indexEdges(n, v);
+     }
+     rebuildParents(n);
+     free(from); free(to);
+     free(start); free(order); free(fill);
+
+     reset(n);
+     return n;
 }
 
 bool deleteNode(network *n, item x){
      if(empty(n)) return false;
-     int index = getIndex(n->size, n->inventory, x);
+     int index = getSlot(n, x);
      if(index == -1) return false;
      node *itemToRemove = n->inventory[index];
-     //Remove the node from the network
-     deleteFromArr(n->size, n->inventory, x);
-     n->size = n->size - 1;
-     //Remove all edges leading to the node
-     for(int i = 0; i < n->size; i++){
-          node *m = n->inventory[i];
-          if(deleteFromArr(m->links, m->edge, x)) m->links = m->links - 1;
+     n->version++;
+     //Every path through the node is about to go
+     if(n->tracked != NULL) trackCut(n, index);
+
+     //Remove the edges leading to the node, visiting only the nodes that have one
+     //Each entry says where its edge is, so no edge array or parent list is searched
+     for(int i = 0; i < itemToRemove->parentCount; i++){
+          int from = itemToRemove->parents[i];
+          if(from != index) dropEdge(n, n->inventory[from], itemToRemove->parentEdge[i]);
+     }
+     //Forget the node as a parent of the nodes it leads to
+     for(int i = 0; i < itemToRemove->links; i++){
+          int to = itemToRemove->edge[i].target;
+          if(to != index) removeParent(n, n->inventory[to], itemToRemove->edge[i].back);
+     }
+
+     //Remove the node from the network by moving the last node into its slot
+     unindexItem(n, x);
+     int last = n->size - 1;
+     if(index != last){
+          node *moved = n->inventory[last];
+          n->inventory[index] = moved;
+          indexSlot(n, index);
+          //Only the edges into and out of the moved node mention its old slot
+          for(int i = 0; i < moved->links; i++){
+               int to = moved->edge[i].target;
+               n->inventory[to == last ? index : to]->parents[moved->edge[i].back] = index;
+          }
+          for(int i = 0; i < moved->parentCount; i++){
+               retarget(n->inventory[moved->parents[i]], moved->parentEdge[i], index);
+          }
      }
+     n->size = n->size - 1;
+     if(n->tracked != NULL) trackRemove(n, index, last);
+
      //If the node to be deleted is the current node
      if(itemToRemove == n->current){
           //If there exists a root, make that the current node
@@ -308,24 +1032,44 @@ bool deleteNode(network *n, item x){
           else if(empty(n)) n->current = NULL;
           //If not, select the first item in the network
           else n->current = n->inventory[0];
-          //If the root was the removed item, make the root NULL - manual setting required afterwards
-          if(n->root == itemToRemove) n->root = NULL;
      }
-     freeNode(itemToRemove);
+     //If the root was the removed item, make the root NULL - manual setting required afterwards
+     if(n->root == itemToRemove) n->root = NULL;
+     freeNode(n, itemToRemove);
      return true;
 }
 
-void freeNode(node *n){
-     free(n->edge);
-     free(n->weight);
-     free(n);
+void freeNode(network *n, node *v){
+     if(n->arena) return;
+     free(v->edge);
+     free(v->lookup);
+     free(v->parents);
+     free(v->parentEdge);
+     free(v);
 }
 
 void freeNetwork(network *n){
-     for(int i = 0; i < n->size; i++){
-          freeNode(n->inventory[i]);
+     if(n->arena){
+          //Every node and edge array is inside a slab, so only the slabs need freeing
+          while(n->slabs != NULL){
+               slab *next = n->slabs->next;
+               free(n->slabs);
+               n->slabs = next;
+          }
      }
+     else{
+          for(int i = 0; i < n->size; i++){
+               freeNode(n, n->inventory[i]);
+          }
+     }
+     if(n->cache != NULL){
+          for(int i = 0; i < CACHED_TREES; i++) { free(n->cache[i].d); free(n->cache[i].p); }
+          free(n->cache);
+     }
+     stopTracking(n);
+     if(n->search != NULL) freeSearcher(n->search);
      free(n->inventory);
+     free(n->buckets);
      free(n);
 }
 
@@ -342,13 +1086,9 @@ item getRoot(network *n){
 
 double getWeight(network *n, item y){
      if(empty(n)) return -1;
-     node *x = n->current;
-     for(int i = 0; i < x->links; i++){
-          if(x->edge[i]->x == y){
-               return x->weight[i];
-          }
-     }
-     return -1;
+     int i = findEdgeTo(n, y);
+     if(i == -1) return -1;
+     return n->current->edge[i].weight;
 }
 
 bool set(network *n, item x){
@@ -358,7 +1098,19 @@ bool set(network *n, item x){
      if(x == n->null) return false;
      //If attempting to set the node to an already existing value
      if(find(n, x) != NULL) return false;
+     int slot = getSlot(n, n->current->x);
+     unindexItem(n, n->current->x);
      n->current->x = x;
+     indexSlot(n, slot);
+     n->version++;
+     if(n->tracked != NULL){
+          //Only the nodes whose paths come straight from this one give its item
+          tracker *t = n->tracked;
+          for(int i = 0; i < n->current->links; i++){
+               int v = n->current->edge[i].target;
+               if(t->prev[v] == slot) t->p[v] = x;
+          }
+     }
      return true;
 }
 
@@ -374,13 +1126,21 @@ bool setRoot(network *n, item r){
 bool setWeight(network *n, item y, double w){
      if(empty(n)) return false;
      if(w < 0) return false;
-     node *x = n->current;
-     for(int i = 0; i < x->links; i++){
-          if(x->edge[i]->x == y){
-               x->weight[i] = w; return true;
+     int i = findEdgeTo(n, y);
+     if(i == -1) return false;
+     double old = n->current->edge[i].weight;
+     n->current->edge[i].weight = w;
+     n->version++;
+     if(n->tracked != NULL){
+          int from = getSlot(n, n->current->x), to = n->current->edge[i].target;
+          if(w < old) trackLower(n, from, to, w);
+          //A heavier edge only matters if a shortest path used it
+          else if(w > old && n->tracked->prev[to] == from){
+               trackCut(n, to);
+               trackRepair(n);
           }
      }
-     return false;
+     return true;
 }
 
 int nodes(network *n){
@@ -393,15 +1153,10 @@ int edges(network *n){
 
 bool traverse(network *n, item x){
      if(n->current == NULL) return false;
-     node *v = n->current;
-     int length = v->links;
-     for(int i = 0; i < length; i++){
-          if(v->edge[i]->x == x){
-               n->current = v->edge[i];
-               return true;
-          }
-     }
-     return false;
+     int i = findEdgeTo(n, x);
+     if(i == -1) return false;
+     n->current = n->inventory[n->current->edge[i].target];
+     return true;
 }
 
 bool reset(network *n){
@@ -413,275 +1168,1267 @@ bool reset(network *n){
 node *find(network *n, item x){
      if(n->current == NULL) return NULL;
 
-     int len = n->size;
-     for(int i = 0; i < len; i++){
-          node *v = n->inventory[i];
-          if(v->x == x) return v;
-     }
-     return NULL;
+     int slot = getSlot(n, x);
+     if(slot == -1) return NULL;
+     return n->inventory[slot];
 }
 
-bool contains(int len, node **arr, item x){
-     for(int i = 0; i < len; i++){
-          if(arr[i]->x == x){
-               return true;
-          }
-     }
-     return false;
+int hashItem(item x, int count){
+     //Fibonacci hashing - spreads consecutive items across the table
+     unsigned int h = (unsigned int)x * 2654435769u;
+     h ^= h >> 16;
+     return h & (count - 1);
 }
 
-bool link(network *n, item y, double w){
-     if(empty(n)) return false;
-     if(w < 0) return false;
-
-     node *nodeX = n->current;
-     if(contains(nodeX->links, nodeX->edge, y)) return false;
-     node *nodeY = find(n, y);
-
-     if(nodeY == NULL) return false;
-
-     if(nodeX->links == nodeX->capacity){
-          nodeX->capacity *= GROWTH_RATE;
-          nodeX->edge = realloc(nodeX->edge, nodeX->capacity * sizeof(node));
-          nodeX->weight = realloc(nodeX->edge, nodeX->capacity * sizeof(double));
+int getSlot(const network *n, item x){
+     int b = hashItem(x, n->bucketCount);
+     while(n->buckets[b] != -1){
+          int slot = n->buckets[b];
+          if(n->inventory[slot]->x == x) return slot;
+          b = (b + 1) & (n->bucketCount - 1);
      }
-
-     nodeX->edge[nodeX->links] = nodeY;
-     nodeX->weight[nodeX->links] = w;
-     nodeX->links++;
-     return true;
+     return -1;
 }
 
-bool deleteFromArr(int len, node **arr, item x){
-     bool isDone = false;
-     for(int i = 0; i < len && !isDone; i++){
-          if(arr[i]->x == x){
-               isDone = true;
-               for(int j = i; j < len - 1; j++){
-                    arr[j] = arr[j + 1];
-               }
-               arr[len - 1] = NULL;
-          }
+void indexSlot(network *n, int slot){
+     //Grow before the table becomes more than half full
+     if(n->size * 2 > n->bucketCount){
+          free(n->buckets);
+          n->bucketCount *= 2;
+          n->buckets = malloc(n->bucketCount * sizeof(int));
+          rebuildIndex(n);
+          return;
+     }
+     item x = n->inventory[slot]->x;
+     int b = hashItem(x, n->bucketCount);
+     while(n->buckets[b] != -1){
+          //Already present - the node has moved slot
+          if(n->inventory[n->buckets[b]]->x == x) break;
+          b = (b + 1) & (n->bucketCount - 1);
      }
-     return isDone;
+     n->buckets[b] = slot;
 }
 
-bool deleteWeight(int len, double *arr, int index){
-     bool isDone = false;
-     for(int i = 0; i < len && !isDone; i++){
-          if(i == index){
-               isDone = true;
-               for(int j = i; j < len - 1; j++){
-                    arr[j] = arr[j + 1];
-               }
-               arr[len - 1] = -1;
+void unindexItem(network *n, item x){
+     int mask = n->bucketCount - 1;
+     int b = hashItem(x, n->bucketCount);
+     while(n->buckets[b] != -1 && n->inventory[n->buckets[b]]->x != x){
+          b = (b + 1) & mask;
+     }
+     if(n->buckets[b] == -1) return;
+     n->buckets[b] = -1;
+     //Pull back any entry further along the run that can no longer be reached
+     int gap = b;
+     for(int j = (b + 1) & mask; n->buckets[j] != -1; j = (j + 1) & mask){
+          int home = hashItem(n->inventory[n->buckets[j]]->x, n->bucketCount);
+          //The entry may move into the gap if its home is not cyclically in (gap, j]
+          if(((j - home) & mask) >= ((j - gap) & mask)){
+               n->buckets[gap] = n->buckets[j];
+               n->buckets[j] = -1;
+               gap = j;
           }
      }
-     return isDone;
 }
 
-bool unlink(network *n, item y){
-     //If network is empty, return false and do nothing.
-     if(empty(n)) return false;
-
-     node *nodeX = n->current;
+void rebuildIndex(network *n){
+     for(int i = 0; i < n->bucketCount; i++) { n->buckets[i] = -1; }
+     for(int i = 0; i < n->size; i++){
+          item x = n->inventory[i]->x;
+          int b = hashItem(x, n->bucketCount);
+          while(n->buckets[b] != -1) { b = (b + 1) & (n->bucketCount - 1); }
+          n->buckets[b] = i;
+     }
+}
 
-     int index = getIndex(nodeX->links, nodeX->edge, y);
-     if(index == -1) return false;
+int findEdge(node *v, int slot){
+     if(v->lookup == NULL){
+          for(int i = 0; i < v->links; i++){
+               if(v->edge[i].target == slot) return i;
+          }
+          return -1;
+     }
+     int b = hashItem(slot, v->lookupSize);
+     while(v->lookup[b] != -1){
+          if(v->edge[v->lookup[b]].target == slot) return v->lookup[b];
+          b = (b + 1) & (v->lookupSize - 1);
+     }
+     return -1;
+}
 
-     deleteFromArr(nodeX->links, nodeX->edge, y);
-     deleteWeight(nodeX->links, nodeX->weight, index);
+int findEdgeTo(network *n, item y){
+     int slot = getSlot(n, y);
+     if(slot == -1) return -1;
+     return findEdge(n->current, slot);
+}
 
-     nodeX->links--;
-     return true;
+void addEdge(network *n, int from, int to, double w){
+     node *v = n->inventory[from];
+     if(v->links == v->capacity){
+          growEdges(n, v, v->capacity * GROWTH_RATE + 1);
+     }
+     v->edge[v->links].target = to;
+     v->edge[v->links].weight = w;
+     v->links++;
+     addParent(n, n->inventory[to], from, v->links - 1);
+
+     //Keep the table at most half full, rebuilding it bigger when needed
+     if(v->links > HUB_EDGES && (v->lookup == NULL || v->links * 2 > v->lookupSize)){
+          indexEdges(n, v);
+     }
+     else lookupInsert(v, v->links - 1);
 }
 
-bool isNodeCyclic(node *n, int k, item visited[]){
-     for(int i = 0; i < k; i++){
-          if(visited[i] == n->x) return true;
+void removeEdge(network *n, int from, int i){
+     node *v = n->inventory[from];
+     removeParent(n, n->inventory[v->edge[i].target], v->edge[i].back);
+     //Each edge above i moves down one, so its target's record of it changes too
+     for(int j = i; j < v->links - 1; j++){
+          v->edge[j] = v->edge[j + 1];
+          n->inventory[v->edge[j].target]->parentEdge[v->edge[j].back] = j;
      }
-     visited[k] = n->x; k++;
+     v->links--;
+     if(v->lookup != NULL) indexEdges(n, v);
+}
 
-     for(int i = 0; i < n->links; i++){
-          if(isNodeCyclic(n->edge[i], k, visited)){
-               return true;
-          }
+void dropEdge(network *n, node *v, int i){
+     int last = v->links - 1;
+     lookupRemove(v, i);
+     if(i != last){
+          //Only the last edge moves, so only its table entry and its target's record of it change
+          lookupRemove(v, last);
+          v->edge[i] = v->edge[last];
+          n->inventory[v->edge[i].target]->parentEdge[v->edge[i].back] = i;
+          lookupInsert(v, i);
      }
-     return false;
+     v->links--;
+     //Drops the table once v is no longer a hub
+     if(v->lookup != NULL && v->links <= HUB_EDGES) indexEdges(n, v);
 }
 
-bool isCyclic(network *n){
-     if(empty(n)) return false;
+void retarget(node *v, int i, int slot){
+     lookupRemove(v, i);
+     v->edge[i].target = slot;
+     lookupInsert(v, i);
+}
 
-     item visited[n->size];
-     return isNodeCyclic(n->current, 0, visited);
+void lookupInsert(node *v, int i){
+     if(v->lookup == NULL) return;
+     int b = hashItem(v->edge[i].target, v->lookupSize);
+     while(v->lookup[b] != -1) { b = (b + 1) & (v->lookupSize - 1); }
+     v->lookup[b] = i;
 }
 
-bool isTree(network *n){
-     //If the network is cyclic, it's not a tree
-     if(isCyclic(n)) return false;
-     //Find how many parents each node has
-     int parents[n->size]; for(int i = 0; i < n->size; i++) { parents[i] = 0; }
-     for(int i = 0; i < n->size; i++){
-          node *current = n->inventory[i];
-          for(int j = 0; j < current->links; j++){
-               int index = getIndex(n->size, n->inventory, current->edge[j]->x);
-               if(parents[index] >= 1) return false;
-               parents[index]++;
+void lookupRemove(node *v, int i){
+     if(v->lookup == NULL) return;
+     int mask = v->lookupSize - 1;
+     int b = hashItem(v->edge[i].target, v->lookupSize);
+     while(v->lookup[b] != i) { b = (b + 1) & mask; }
+     v->lookup[b] = -1;
+     //Pull back any entry further along the run that can no longer be reached, as in unindexItem
+     int gap = b;
+     for(int j = (b + 1) & mask; v->lookup[j] != -1; j = (j + 1) & mask){
+          int home = hashItem(v->edge[v->lookup[j]].target, v->lookupSize);
+          if(((j - home) & mask) >= ((j - gap) & mask)){
+               v->lookup[gap] = v->lookup[j];
+               v->lookup[j] = -1;
+               gap = j;
           }
      }
-     //If each node doesn't have exactly one parent, it's not a tree
-     for(int i = 0; i < n->size; i++){
-          if(n->inventory[i] == n->root){
-               if(parents[i] != 0) return false;
+}
+
+void addParent(network *n, node *v, int slot, int i){
+     if(v->parentCount == v->parentCapacity){
+          int capacity = v->parentCapacity * GROWTH_RATE + 1;
+          if(!n->arena){
+               v->parents = realloc(v->parents, capacity * sizeof(int));
+               v->parentEdge = realloc(v->parentEdge, capacity * sizeof(int));
           }
           else{
-               if(parents[i] != 1) return false;
+               int *parents = allocate(n, capacity * sizeof(int));
+               int *parentEdge = allocate(n, capacity * sizeof(int));
+               if(v->parentCount > 0){
+                    memcpy(parents, v->parents, v->parentCount * sizeof(int));
+                    memcpy(parentEdge, v->parentEdge, v->parentCount * sizeof(int));
+               }
+               v->parents = parents;
+               v->parentEdge = parentEdge;
           }
+          v->parentCapacity = capacity;
      }
-     return true;
+     v->parents[v->parentCount] = slot;
+     v->parentEdge[v->parentCount] = i;
+     n->inventory[slot]->edge[i].back = v->parentCount;
+     v->parentCount++;
 }
 
-int getIndex(int len, node **arr, item x){
-     for(int i = 0; i < len; i++){
-          if(arr[i]->x == x) return i;
+void removeParent(network *n, node *v, int i){
+     //Order doesn't matter, so the last entry fills the gap, and its edge is told where it went
+     v->parentCount--;
+     int last = v->parentCount;
+     if(i == last) return;
+     v->parents[i] = v->parents[last];
+     v->parentEdge[i] = v->parentEdge[last];
+     n->inventory[v->parents[i]]->edge[v->parentEdge[i]].back = i;
+}
+
+void rebuildParents(network *n){
+     for(int i = 0; i < n->size; i++) { n->inventory[i]->parentCount = 0; }
+     for(int i = 0; i < n->size; i++){
+          node *v = n->inventory[i];
+          for(int j = 0; j < v->links; j++) { addParent(n, n->inventory[v->edge[j].target], i, j); }
      }
-     return -1;
 }
 
-int depthNode(node *current){
-     int depth = 1;
-     for(int i = 0; i < current->links; i++){
-          node *neighbour = current->edge[i];
-          int x = 1 + depthNode(neighbour);
-          if(x > depth) depth = x;
+void indexEdges(network *n, node *v){
+     if(v->links <= HUB_EDGES){
+          if(!n->arena) free(v->lookup);
+          v->lookup = NULL;
+          v->lookupSize = 0;
+          return;
+     }
+     int size = 2 * INITIAL_BUCKETS;
+     while(size < 2 * v->links) { size *= 2; }
+     if(size > v->lookupSize){
+          if(!n->arena) free(v->lookup);
+          v->lookup = allocate(n, size * sizeof(int));
+          v->lookupSize = size;
+     }
+     for(int b = 0; b < v->lookupSize; b++) { v->lookup[b] = -1; }
+     for(int i = 0; i < v->links; i++){
+          int b = hashItem(v->edge[i].target, v->lookupSize);
+          while(v->lookup[b] != -1) { b = (b + 1) & (v->lookupSize - 1); }
+          v->lookup[b] = i;
      }
-     return depth;
 }
 
-int depth(network *n){
-     if(empty(n)) return 0;
-     if(isTree(n) == false) return -1;
+bool link(network *n, item y, double w){
+     if(empty(n)) return false;
+     if(w < 0) return false;
 
-     return depthNode(n->current);
+     node *nodeX = n->current;
+     int slotY = getSlot(n, y);
+     if(slotY == -1) return false;
+     if(findEdge(nodeX, slotY) != -1) return false;
+
+     int slotX = getSlot(n, nodeX->x);
+     addEdge(n, slotX, slotY, w);
+     n->version++;
+     if(n->tracked != NULL) trackLower(n, slotX, slotY, w);
+     return true;
 }
 
-node *depthSearchNode(node *n, item x, int k, item visited[]){
-     if(n->x == x) return n;
-     for(int i = 0; i < k; i++){
-          if(visited[i] == n->x) return NULL;
-     }
-     visited[k] = n->x; k++;
-     for(int i = 0; i < n->links; i++){
-          node *m = depthSearchNode(n->edge[i], x, k, visited);
-          if(m != NULL) return m;
+bool unlink(network *n, item y){
+     //If network is empty, return false and do nothing.
+     if(empty(n)) return false;
+
+     int index = findEdgeTo(n, y);
+     if(index == -1) return false;
+
+     int from = getSlot(n, n->current->x), to = n->current->edge[index].target;
+     removeEdge(n, from, index);
+     n->version++;
+     //Only the nodes whose shortest paths used the edge need new ones
+     if(n->tracked != NULL && n->tracked->prev[to] == from){
+          trackCut(n, to);
+          trackRepair(n);
      }
-     return NULL;
+     return true;
 }
 
-bool depthFirstSearch(network *n, item x, bool goTo){
+bool isCyclic(network *n){
      if(empty(n)) return false;
-     item visited[n->size];
-     node *m = depthSearchNode(n->root, x, 0, visited);
-     if(m == NULL) return false;
-     if(goTo) n->current = m;
-     return true;
-}
 
-bool breadthFirstSearch(network *n, item x, bool goTo){
-     //Initialise 'queue' array
-     node *q[n->size]; int back = 0;
-     item visited[n->size]; int k = 0;
-     for(int i = 0; i < n->size; i++){ q[i] = NULL; }
-     //Enqueue root
-     q[0] = n->root; back++;
-     while(q[0] != NULL){
-          //Dequeue
-          node *v = q[0];
-          deleteFromArr(n->size, q, v->x);
-          back--;
-          //If v is the node to find
-          if(v->x == x){
-               if(goTo) n->current = v;
-               return true;
+     //0 = unvisited, 1 = on the current path, 2 = finished with
+     //Reaching a node still on the path means there is a cycle
+     char *state = calloc(n->size, sizeof(char));
+     //next[u] is the next edge of u to follow when u is on top of the stack
+     int *next = calloc(n->size, sizeof(int));
+     int *stack = malloc(n->size * sizeof(int));
+     int top = 0;
+     bool cyclic = false;
+
+     int start = getSlot(n, n->current->x);
+     stack[top++] = start; state[start] = 1;
+     while(top > 0 && !cyclic){
+          int u = stack[top - 1];
+          node *v = n->inventory[u];
+          if(next[u] == v->links){
+               state[u] = 2; top--;
           }
-          for(int i = 0; i < v->links; i++){
-               node *w = v->edge[i];
-               bool isWDiscovered = false;
-               //Check if w is already visited
-               for(int j = 0; j < k && !isWDiscovered; j++){
-                    if(visited[j] == w->x) isWDiscovered = true;
+          else{
+               int w = v->edge[next[u]].target; next[u]++;
+               if(state[w] == 1) cyclic = true;
+               else if(state[w] == 0) { state[w] = 1; stack[top++] = w; }
+          }
+     }
+     free(state);
+     free(next);
+     free(stack);
+     return cyclic;
+}
+
+int strongComponents(const network *n, int *component){
+     if(n->size == 0) return 0;
+     //Tarjan's algorithm, with the recursion replaced by an explicit stack as in isCyclic
+     //order[u] is when u was first reached, or -1, and low[u] the earliest node it can get back to
+     int *order = malloc(n->size * sizeof(int));
+     int *low = malloc(n->size * sizeof(int));
+     int *next = calloc(n->size, sizeof(int));
+     int *path = malloc(n->size * sizeof(int));
+     //Reached nodes not yet given a component, in the order they were reached
+     int *waiting = malloc(n->size * sizeof(int));
+     bool *isWaiting = calloc(n->size, sizeof(bool));
+     for(int i = 0; i < n->size; i++) { order[i] = -1; }
+     int count = 0, reached = 0, waitingCount = 0;
+
+     for(int start = 0; start < n->size; start++){
+          if(order[start] != -1) continue;
+          int top = 0;
+          path[top++] = start;
+          order[start] = low[start] = reached++;
+          waiting[waitingCount++] = start; isWaiting[start] = true;
+          while(top > 0){
+               int u = path[top - 1];
+               node *v = n->inventory[u];
+               if(next[u] < v->links){
+                    int w = v->edge[next[u]].target; next[u]++;
+                    if(order[w] == -1){
+                         order[w] = low[w] = reached++;
+                         waiting[waitingCount++] = w; isWaiting[w] = true;
+                         path[top++] = w;
+                    }
+                    else if(isWaiting[w] && order[w] < low[u]) low[u] = order[w];
+                    continue;
                }
-               //If not, enqueue w and make visited
-               if(!isWDiscovered) {
-                    visited[k] = w->x; k++;
-                    q[back] = w; back++;
+               //Every edge of u has been followed
+               top--;
+               if(low[u] == order[u]){
+                    //u is the first node reached of its component, which is everything waiting above it
+                    int w;
+                    do{
+                         w = waiting[--waitingCount];
+                         isWaiting[w] = false;
+                         component[w] = count;
+                    } while(w != u);
+                    count++;
                }
+               if(top > 0 && low[u] < low[path[top - 1]]) low[path[top - 1]] = low[u];
           }
      }
-     return false;
+     //Tarjan finishes components with no edges out first - number them the other way round
+     //so that every edge between components goes from a lower number to a higher one
+     for(int i = 0; i < n->size; i++) { component[i] = count - 1 - component[i]; }
+     free(order); free(low); free(next); free(path);
+     free(waiting); free(isWaiting);
+     return count;
 }
 
-bool isSubNet(network *n, network *m){
-     if(empty(n) || empty(m)) return false;
-     for(int i = 0; i < m->size; i++){
-          node *mNode = m->inventory[i];
-          item x = mNode->x;
-          node *nNode = find(n, x);
-
-          if(nNode == NULL) return false;
-          for(int j = 0; j < mNode->links; j++){
-               if(contains(nNode->links, nNode->edge, mNode->edge[j]->x) == false)
-                    return false;
+network *condense(const network *n){
+     network *c = newNetwork(-1);
+     if(n->size == 0) return c;
+     int *component = malloc(n->size * sizeof(int));
+     int count = strongComponents(n, component);
+     reserveNodes(c, count);
+     for(int i = 0; i < count; i++) { appendNode(c, newNode(c, i, 0)); }
+
+     //Group the nodes by component with a counting sort
+     int *start = calloc(count + 1, sizeof(int));
+     for(int i = 0; i < n->size; i++) { start[component[i] + 1]++; }
+     for(int i = 0; i < count; i++) { start[i + 1] += start[i]; }
+     int *members = malloc(n->size * sizeof(int));
+     int *fill = malloc((count + 1) * sizeof(int));
+     memcpy(fill, start, count * sizeof(int));
+     for(int i = 0; i < n->size; i++) { members[fill[component[i]]++] = i; }
+
+     //seen[b] == a marks that component a already has an edge to b, at index at[b] of its edge array,
+     //so that repeats keep the lightest weight
+     int *seen = fill, *at = malloc((count + 1) * sizeof(int));
+     for(int i = 0; i < count; i++) { seen[i] = -1; }
+     for(int a = 0; a < count; a++){
+          node *from = c->inventory[a];
+          for(int k = start[a]; k < start[a + 1]; k++){
+               node *v = n->inventory[members[k]];
+               for(int i = 0; i < v->links; i++){
+                    int b = component[v->edge[i].target];
+                    double w = v->edge[i].weight;
+                    if(b == a) continue;
+                    if(seen[b] != a){
+                         seen[b] = a; at[b] = from->links;
+                         addEdge(c, a, b, w);
+                    }
+                    else if(w < from->edge[at[b]].weight) from->edge[at[b]].weight = w;
+               }
           }
      }
-     return true;
+     if(n->root != NULL) c->root = c->inventory[component[getSlot(n, n->root->x)]];
+     reset(c);
+     free(component); free(start); free(members); free(fill); free(at);
+     return c;
 }
 
-void dijkstraNode(network *n, node *current, double *d, item *p, int k, item visited[]){
-     for(int i = 0; i < k; i++){
-          if(visited[i] == current->x) return;
+int orderLevels(const network *n, int *order, int *levelStart){
+     //waiting[v] counts the parents of v not yet put in order
+     int *waiting = malloc((n->size + 1) * sizeof(int));
+     int count = 0;
+     for(int i = 0; i < n->size; i++){
+          waiting[i] = n->inventory[i]->parentCount;
+          if(waiting[i] == 0) order[count++] = i;
      }
-     visited[k] = current->x; k++;
-
-     int currentIndex = getIndex(n->size, n->inventory, current->x);
-     for(int i = 0; i < current->links; i++){
-          node *neighbour = current->edge[i];
-          int index = getIndex(n->size, n->inventory, neighbour->x);
-
-          double w = current->weight[i];
-          if(d[currentIndex] != -1) w += d[currentIndex];
-          if(d[index] > w || d[index] == -1){
-               d[index] = w;
-               p[index] = current->x;
-               dijkstraNode(n, neighbour, d, p, k, visited);
+     //order doubles as the queue - the current level is order[begin] to order[end - 1]
+     int levels = 0, begin = 0;
+     while(begin < count){
+          int end = count;
+          if(levelStart != NULL) levelStart[levels] = begin;
+          levels++;
+          for(int k = begin; k < end; k++){
+               node *v = n->inventory[order[k]];
+               for(int i = 0; i < v->links; i++){
+                    int w = v->edge[i].target;
+                    if(--waiting[w] == 0) order[count++] = w;
+               }
           }
+          begin = end;
      }
+     free(waiting);
+     //Nodes on a cycle never run out of waiting parents
+     if(count < n->size) return -1;
+     if(levelStart != NULL) levelStart[levels] = count;
+     return levels;
+}
+
+int topologicalOrder(const network *n, item *out){
+     int *order = malloc((n->size + 1) * sizeof(int));
+     int levels = orderLevels(n, order, NULL);
+     if(levels != -1){
+          for(int i = 0; i < n->size; i++) { out[i] = n->inventory[order[i]]->x; }
+     }
+     free(order);
+     return (levels == -1) ? -1 : n->size;
+}
+
+int topologicalLevels(const network *n, item *out, int *levelStart){
+     int *order = malloc((n->size + 1) * sizeof(int));
+     int levels = orderLevels(n, order, levelStart);
+     if(levels != -1){
+          for(int i = 0; i < n->size; i++) { out[i] = n->inventory[order[i]]->x; }
+     }
+     else levelStart[0] = 0;
+     free(order);
+     return levels;
+}
+
+int treeDepth(network *n){
+     if(empty(n)) return 0;
+     if(n->root == NULL) return -1;
+
+     //Each node keeps a list of its parents, so checking how many there are is one pass
+     int root = getSlot(n, n->root->x);
+     bool valid = n->root->parentCount == 0;
+     for(int i = 0; i < n->size && valid; i++){
+          if(i != root && n->inventory[i]->parentCount != 1) valid = false;
+     }
+     if(!valid) return -1;
+
+     //Every node now has at most one parent, so the walk below reaches each node once.
+     //Any cycle would be cut off from the root, which the reached count exposes.
+     queue *q = newQueue(n->size);
+     enqueue(q, root);
+     int reached = 0, levels = 0;
+     while(!queueEmpty(q)){
+          levels++;
+          //Everything in the queue at this point is on the same level
+          for(int k = q->count; k > 0; k--){
+               node *v = n->inventory[dequeue(q)];
+               reached++;
+               for(int i = 0; i < v->links; i++) { enqueue(q, v->edge[i].target); }
+          }
+     }
+     freeQueue(q);
+     if(reached != n->size) return -1;
+     return levels;
+}
+
+bool isTree(network *n){
+     return treeDepth(n) != -1;
+}
+
+int depth(network *n){
+     return treeDepth(n);
+}
+
+bool depthFirstSearch(network *n, item x, bool goTo){
+     if(empty(n) || n->root == NULL) return false;
+
+     //Nodes are marked when pushed, so each is pushed at most once
+     bool *visited = calloc(n->size, sizeof(bool));
+     int *stack = malloc(n->size * sizeof(int));
+     int top = 0;
+     int start = getSlot(n, n->root->x);
+     stack[top++] = start; visited[start] = true;
+     node *m = NULL;
+     while(top > 0 && m == NULL){
+          node *v = n->inventory[stack[--top]];
+          if(v->x == x) m = v;
+          //Pushed in reverse so the first edge is explored first
+          for(int i = v->links - 1; i >= 0; i--){
+               int w = v->edge[i].target;
+               if(!visited[w]) { visited[w] = true; stack[top++] = w; }
+          }
+     }
+     free(visited);
+     free(stack);
+     if(m == NULL) return false;
+     if(goTo) n->current = m;
+     return true;
+}
+
+queue *newQueue(int capacity){
+     queue *q = malloc(sizeof(queue));
+     q->capacity = capacity;
+     q->head = 0;
+     q->tail = 0;
+     q->count = 0;
+     q->slots = malloc((capacity + 1) * sizeof(int));
+     return q;
+}
+
+void freeQueue(queue *q){
+     free(q->slots);
+     free(q);
+}
+
+bool queueEmpty(queue *q){
+     return q->count == 0;
+}
+
+void enqueue(queue *q, int slot){
+     q->slots[q->tail] = slot;
+     q->tail = (q->tail + 1) % q->capacity;
+     q->count++;
+}
+
+int dequeue(queue *q){
+     int slot = q->slots[q->head];
+     q->head = (q->head + 1) % q->capacity;
+     q->count--;
+     return slot;
+}
+
+node *breadthWalk(network *n, item x, item *out, int *count){
+     int k = 0;
+     node *found = NULL;
+     if(!empty(n) && n->root != NULL){
+          //Nodes are marked when enqueued, so each one is enqueued at most once
+          bool *visited = calloc(n->size, sizeof(bool));
+          queue *q = newQueue(n->size);
+          int start = getSlot(n, n->root->x);
+          enqueue(q, start); visited[start] = true;
+          while(!queueEmpty(q) && found == NULL){
+               node *v = n->inventory[dequeue(q)];
+               if(out != NULL) out[k] = v->x;
+               k++;
+               if(v->x == x) found = v;
+               for(int i = 0; i < v->links; i++){
+                    int w = v->edge[i].target;
+                    if(!visited[w]) { visited[w] = true; enqueue(q, w); }
+               }
+          }
+          free(visited);
+          freeQueue(q);
+     }
+     if(count != NULL) *count = k;
+     return found;
+}
+
+bool breadthFirstSearch(network *n, item x, bool goTo){
+     node *v = breadthWalk(n, x, NULL, NULL);
+     if(v == NULL) return false;
+     if(goTo) n->current = v;
+     return true;
+}
+
+int breadthFirstOrder(network *n, item *out){
+     int count;
+     //The null value is never in the network, so the walk never stops early
+     breadthWalk(n, n->null, out, &count);
+     return count;
+}
+
+bool isSubNet(network *n, network *m){
+     if(empty(n) || empty(m)) return false;
+     if(m->size > n->size) return false;
+     //match[i] is the slot in n of the node in slot i of m, found once so that edges are
+     //checked slot to slot without looking their items up again
+     int *match = malloc(m->size * sizeof(int));
+     bool subnet = true;
+     for(int i = 0; i < m->size && subnet; i++){
+          node *mNode = m->inventory[i];
+          match[i] = getSlot(n, mNode->x);
+          //A node of n with fewer edges can't have all of them
+          if(match[i] == -1 || n->inventory[match[i]]->links < mNode->links) subnet = false;
+     }
+     for(int i = 0; i < m->size && subnet; i++){
+          node *mNode = m->inventory[i], *nNode = n->inventory[match[i]];
+          for(int j = 0; j < mNode->links && subnet; j++){
+               if(findEdge(nNode, match[mNode->edge[j].target]) == -1) subnet = false;
+          }
+     }
+     free(match);
+     return subnet;
+}
+
+int findSubNets(const network *host, const network *pattern, int limit,
+                bool (*found)(const item *match, void *ctx), void *ctx){
+     int size = pattern->size;
+     if(size == 0 || size > host->size) return 0;
+     matchStep *steps = malloc(size * sizeof(matchStep));
+     orderPattern(pattern, steps);
+     //next[k] is the index of the next candidate to try at step k
+     int *map = malloc(size * sizeof(int)), *next = malloc(size * sizeof(int));
+     item *match = malloc(size * sizeof(item));
+     bool *used = calloc(host->size, sizeof(bool));
+     for(int i = 0; i < size; i++) { map[i] = -1; }
+
+     int count = 0, k = 0;
+     next[0] = 0;
+     bool stop = false;
+     //The recursion of VF2 kept on an explicit stack of steps
+     while(k >= 0 && !stop){
+          matchStep *step = &steps[k];
+          int u = step->slot;
+          if(map[u] != -1) { used[map[u]] = false; map[u] = -1; }
+          //The candidates for this step, from the anchor's match or the whole host
+          int total;
+          const node *anchor = NULL;
+          if(step->anchor == -1) total = host->size;
+          else{
+               anchor = host->inventory[map[steps[step->anchor].slot]];
+               total = step->fromParent ? anchor->parentCount : anchor->links;
+          }
+          int h = -1;
+          while(next[k] < total && h == -1){
+               int c = next[k]++;
+               if(anchor != NULL) c = step->fromParent ? anchor->parents[c] : anchor->edge[c].target;
+               if(!used[c] && canMatch(host, pattern, u, c, map)) h = c;
+          }
+          if(h == -1) { k--; continue; }
+          map[u] = h;
+          used[h] = true;
+          if(k < size - 1) { k++; next[k] = 0; continue; }
+
+          //Every pattern node is matched
+          for(int i = 0; i < size; i++) { match[i] = host->inventory[map[i]]->x; }
+          count++;
+          if(found != NULL && !found(match, ctx)) stop = true;
+          if(limit > 0 && count >= limit) stop = true;
+     }
+     free(steps); free(map); free(next); free(match); free(used);
+     return count;
+}
+
+void orderPattern(const network *pattern, matchStep *steps){
+     int size = pattern->size;
+     //links[v] counts v's edges to placed nodes, or is -1 once v is placed
+     int *links = calloc(size, sizeof(int));
+     int *stepOf = malloc(size * sizeof(int));
+     for(int k = 0; k < size; k++){
+          int best = -1, bestDegree = -1;
+          for(int v = 0; v < size; v++){
+               if(links[v] == -1) continue;
+               node *m = pattern->inventory[v];
+               int degree = m->links + m->parentCount;
+               if(best == -1 || links[v] > links[best] || (links[v] == links[best] && degree > bestDegree)){
+                    best = v;
+                    bestDegree = degree;
+               }
+          }
+          node *m = pattern->inventory[best];
+          steps[k] = (matchStep){.slot = best, .anchor = -1, .fromParent = false};
+          stepOf[best] = k;
+          //Anchor to the latest placed node it is joined to - its match has the fewest candidates left unused
+          for(int i = 0; i < m->parentCount; i++){
+               int w = m->parents[i];
+               if(links[w] != -1 || stepOf[w] <= steps[k].anchor) continue;
+               steps[k].anchor = stepOf[w];
+               steps[k].fromParent = false;
+          }
+          for(int i = 0; i < m->links; i++){
+               int w = m->edge[i].target;
+               if(links[w] != -1 || stepOf[w] <= steps[k].anchor) continue;
+               steps[k].anchor = stepOf[w];
+               steps[k].fromParent = true;
+          }
+          links[best] = -1;
+          for(int i = 0; i < m->links; i++){
+               if(links[m->edge[i].target] != -1) links[m->edge[i].target]++;
+          }
+          for(int i = 0; i < m->parentCount; i++){
+               if(links[m->parents[i]] != -1) links[m->parents[i]]++;
+          }
+     }
+     free(links);
+     free(stepOf);
+}
+
+bool canMatch(const network *host, const network *pattern, int u, int h, const int *map){
+     node *p = pattern->inventory[u], *v = host->inventory[h];
+     if(v->links < p->links || v->parentCount < p->parentCount) return false;
+     //Every edge between u and a matched node, or from u to itself, must be in the host
+     for(int i = 0; i < p->links; i++){
+          int w = p->edge[i].target;
+          int target = (w == u) ? h : map[w];
+          if(target != -1 && findEdge(v, target) == -1) return false;
+     }
+     for(int i = 0; i < p->parentCount; i++){
+          int w = p->parents[i];
+          if(w == u || map[w] == -1) continue;
+          node *from = host->inventory[map[w]];
+          if(findEdge(from, h) == -1) return false;
+     }
+     return true;
+}
+
+heap *newHeap(int capacity, double *key){
+     heap *h = malloc(sizeof(heap));
+     h->size = 0;
+     h->key = key;
+     h->slots = malloc((capacity + 1) * sizeof(int));
+     h->pos = malloc((capacity + 1) * sizeof(int));
+     for(int i = 0; i < capacity; i++) { h->pos[i] = -1; }
+     return h;
+}
+
+void freeHeap(heap *h){
+     free(h->slots);
+     free(h->pos);
+     free(h);
+}
+
+bool heapEmpty(heap *h){
+     return h->size == 0;
+}
+
+//Moves the slot at heap position i up until its parent is no larger
+void siftUp(heap *h, int i){
+     int slot = h->slots[i];
+     while(i > 0){
+          int parent = (i - 1) / 2;
+          if(h->key[h->slots[parent]] <= h->key[slot]) break;
+          h->slots[i] = h->slots[parent];
+          h->pos[h->slots[i]] = i;
+          i = parent;
+     }
+     h->slots[i] = slot;
+     h->pos[slot] = i;
+}
+
+//Moves the slot at heap position i down until neither child is smaller
+void siftDown(heap *h, int i){
+     int slot = h->slots[i];
+     while(2 * i + 1 < h->size){
+          int child = 2 * i + 1;
+          if(child + 1 < h->size && h->key[h->slots[child + 1]] < h->key[h->slots[child]]) child++;
+          if(h->key[slot] <= h->key[h->slots[child]]) break;
+          h->slots[i] = h->slots[child];
+          h->pos[h->slots[i]] = i;
+          i = child;
+     }
+     h->slots[i] = slot;
+     h->pos[slot] = i;
+}
+
+void heapPush(heap *h, int slot){
+     h->slots[h->size] = slot;
+     h->size++;
+     siftUp(h, h->size - 1);
+}
+
+void heapDecrease(heap *h, int slot){
+     siftUp(h, h->pos[slot]);
+}
+
+int heapPop(heap *h){
+     int top = h->slots[0];
+     h->pos[top] = -1;
+     h->size--;
+     if(h->size > 0){
+          h->slots[0] = h->slots[h->size];
+          siftDown(h, 0);
+     }
+     return top;
 }
 
 void dijkstra(network *n, double *d, item *p){
+     if(n->root == NULL) { dijkstraFrom(n, n->null, d, p); return; }
+     cachedTree *t = cacheLookup(n, n->root->x);
+     memcpy(d, t->d, n->size * sizeof(double));
+     memcpy(p, t->p, n->size * sizeof(item));
+}
+
+bool cachedDijkstra(network *n, item root, const double **d, const item **p){
+     *d = NULL;
+     *p = NULL;
+     if(getSlot(n, root) == -1) return false;
+     cachedTree *t = cacheLookup(n, root);
+     *d = t->d;
+     *p = t->p;
+     return true;
+}
+
+cachedTree *cacheLookup(network *n, item root){
+     if(n->cache == NULL){
+          n->cache = malloc(CACHED_TREES * sizeof(cachedTree));
+          for(int i = 0; i < CACHED_TREES; i++){
+               n->cache[i] = (cachedTree){.root = n->null, .version = 0, .d = NULL, .p = NULL, .capacity = 0};
+          }
+     }
+     for(int i = 0; i < CACHED_TREES; i++){
+          cachedTree *t = &n->cache[i];
+          if(t->d != NULL && t->version == n->version && t->root == root) return t;
+     }
+     cachedTree *t = &n->cache[n->cacheNext];
+     n->cacheNext = (n->cacheNext + 1) % CACHED_TREES;
+     if(t->capacity < n->size || t->d == NULL){
+          free(t->d); free(t->p);
+          t->capacity = n->size;
+          t->d = malloc((t->capacity + 1) * sizeof(double));
+          t->p = malloc((t->capacity + 1) * sizeof(item));
+     }
+     t->root = root;
+     t->version = n->version;
+     dijkstraFrom(n, root, t->d, t->p);
+     return t;
+}
+
+void dijkstraFrom(const network *n, item root, double *d, item *p){
+     heap *h = newHeap(n->size, d);
+     runDijkstra(n, getSlot(n, root), d, p, h);
+     freeHeap(h);
+}
+
+void dijkstraBatch(const network *n, const item *roots, int count, double *d, item *p, int threads){
+     batch b = {.n = n, .roots = roots, .count = count, .d = d, .p = p, .next = 0};
+#ifndef _WIN32
+     pthread_mutex_init(&b.lock, NULL);
+     if(threads > count) threads = count;
+     pthread_t *workers = malloc((threads > 0 ? threads : 1) * sizeof(pthread_t));
+     //The calling thread is one of the workers, so one fewer is started
+     int started = 0;
+     while(started < threads - 1 && pthread_create(&workers[started], NULL, batchWorker, &b) == 0){
+          started++;
+     }
+     batchWorker(&b);
+     for(int i = 0; i < started; i++) { pthread_join(workers[i], NULL); }
+     free(workers);
+     pthread_mutex_destroy(&b.lock);
+#else
+     //No pthreads, so every root is run by the calling thread
+     (void)threads;
+     batchWorker(&b);
+#endif
+}
+
+void *batchWorker(void *arg){
+     batch *b = arg;
+     heap *h = newHeap(b->n->size, NULL);
+     while(true){
+#ifndef _WIN32
+          pthread_mutex_lock(&b->lock);
+#endif
+          int k = b->next;
+          if(k < b->count) b->next++;
+#ifndef _WIN32
+          pthread_mutex_unlock(&b->lock);
+#endif
+          if(k >= b->count) break;
+          //Each root has its own row, so no two threads write to the same place
+          size_t row = (size_t)k * b->n->size;
+          h->key = b->d + row;
+          runDijkstra(b->n, getSlot(b->n, b->roots[k]), b->d + row, b->p + row, h);
+     }
+     freeHeap(h);
+     return NULL;
+}
+
+void runDijkstra(const network *n, int root, double *d, item *p, heap *h){
      //Set initial distance and previous value
      for(int i = 0; i < n->size; i++){
-          if(n->inventory[i]->x == getRoot(n)) d[i] = 0;
-          else d[i] = -1;
+          d[i] = -1;
           p[i] = n->null;
      }
-     item visited[n->size];
-     dijkstraNode(n, n->root, d, p, 0, visited);
+     if(root == -1) return;
+
+     d[root] = 0;
+     heapPush(h, root);
+     //Each slot leaves the heap once, with its final distance
+     while(!heapEmpty(h)){
+          int u = heapPop(h);
+          node *current = n->inventory[u];
+          for(int i = 0; i < current->links; i++){
+               int v = current->edge[i].target;
+               double w = d[u] + current->edge[i].weight;
+               if(d[v] == -1){
+                    d[v] = w; p[v] = current->x;
+                    heapPush(h, v);
+               }
+               else if(w < d[v]){
+                    d[v] = w; p[v] = current->x;
+                    heapDecrease(h, v);
+               }
+          }
+     }
 }
 
-double getShortestDistance(network *n, item y, double *d){
+void deltaStepping(const network *n, item root, double *d, item *p, double delta, int threads){
      for(int i = 0; i < n->size; i++){
-          if(n->inventory[i]->x == y){
-               return d[i];
+          d[i] = -1;
+          p[i] = n->null;
+     }
+     int rootSlot = getSlot(n, root);
+     if(rootSlot == -1) return;
+#ifdef _WIN32
+     threads = 1;
+#endif
+     if(threads < 1) threads = 1;
+
+     //Without a bucket width, use the heaviest weight over the mean number of edges per node
+     //- the usual choice, which keeps the work done by each light phase close to Dijkstra's
+     double maxWeight = 0;
+     int edgeCount = 0;
+     for(int i = 0; i < n->size; i++){
+          node *v = n->inventory[i];
+          for(int j = 0; j < v->links; j++){
+               if(v->edge[j].weight > maxWeight) maxWeight = v->edge[j].weight;
           }
+          edgeCount += v->links;
      }
-     return -1;
+     //Written this way round so that NaN also gets the default
+     if(!(delta > 0)) delta = (maxWeight > 0) ? maxWeight * n->size / edgeCount : 1;
+     //A very narrow width would need more buckets than can be allocated, and far more steps
+     if(maxWeight / delta > STEP_BUCKETS - 2) delta = maxWeight / (STEP_BUCKETS - 2);
+
+     stepper s = {.n = n, .d = d, .p = p, .delta = delta, .threads = threads};
+     s.cycle = (int)(maxWeight / delta) + 2;
+     s.buckets = calloc(s.cycle, sizeof(int*));
+     s.bucketSize = calloc(s.cycle, sizeof(int));
+     s.bucketCapacity = calloc(s.cycle, sizeof(int));
+     s.bucketOf = malloc((n->size + 1) * sizeof(long long));
+     for(int i = 0; i < n->size; i++) { s.bucketOf[i] = -1; }
+     s.frontier = malloc((n->size + 1) * sizeof(int));
+     s.requests = calloc(threads, sizeof(request*));
+     s.requestCount = calloc(threads, sizeof(int));
+     s.requestCapacity = calloc(threads, sizeof(int));
+     //The nodes taken from the current bucket, whose heavy edges are relaxed once it stays empty
+     int *settled = malloc((n->size + 1) * sizeof(int));
+     bool *isSettled = calloc(n->size + 1, sizeof(bool));
+#ifndef _WIN32
+     pthread_mutex_init(&s.lock, NULL);
+     pthread_cond_init(&s.wake, NULL);
+     pthread_t *workers = malloc(threads * sizeof(pthread_t));
+     int started = 0;
+     while(started < threads - 1 && pthread_create(&workers[started], NULL, stepWorker, &s) == 0){
+          started++;
+     }
+     pthread_mutex_lock(&s.lock);
+     s.threads = started + 1;
+     pthread_mutex_unlock(&s.lock);
+#endif
+
+     d[rootSlot] = 0;
+     stepBucket(&s, rootSlot, 0);
+     for(long long current = 0; s.pending > 0; current++){
+          int b = current % s.cycle;
+          int settledSize = 0;
+          while(true){
+               //Skip nodes that have since moved to another bucket, or appear twice
+               s.frontierSize = 0;
+               for(int i = 0; i < s.bucketSize[b]; i++){
+                    int v = s.buckets[b][i];
+                    if(s.bucketOf[v] != current) continue;
+                    s.bucketOf[v] = -1;
+                    s.pending--;
+                    s.frontier[s.frontierSize++] = v;
+                    if(!isSettled[v]) { isSettled[v] = true; settled[settledSize++] = v; }
+               }
+               s.bucketSize[b] = 0;
+
+               //Light edges can put nodes back in this bucket, so they are relaxed until it stays empty
+               if(s.frontierSize > 0) s.heavy = false;
+               else if(settledSize > 0){
+                    memcpy(s.frontier, settled, settledSize * sizeof(int));
+                    s.frontierSize = settledSize;
+                    for(int i = 0; i < settledSize; i++) { isSettled[settled[i]] = false; }
+                    settledSize = 0;
+                    s.heavy = true;
+               }
+               else break;
+               stepPhase(&s);
+               stepApply(&s, current);
+          }
+     }
+
+#ifndef _WIN32
+     //Wake the other threads one last time so they can see they are done
+     s.done = true;
+     if(s.threads > 1) stepWait(&s);
+     for(int i = 0; i < started; i++) { pthread_join(workers[i], NULL); }
+     free(workers);
+     pthread_mutex_destroy(&s.lock);
+     pthread_cond_destroy(&s.wake);
+#endif
+     for(int t = 0; t < threads; t++) { free(s.requests[t]); }
+     free(s.requests); free(s.requestCount); free(s.requestCapacity);
+     for(int i = 0; i < s.cycle; i++) { free(s.buckets[i]); }
+     free(s.buckets); free(s.bucketSize); free(s.bucketCapacity); free(s.bucketOf);
+     free(s.frontier); free(settled); free(isSettled);
+}
+
+void stepRelax(stepper *s, int t, int start, int end){
+     for(int i = start; i < end; i++){
+          int u = s->frontier[i];
+          node *v = s->n->inventory[u];
+          for(int j = 0; j < v->links; j++){
+               double w = v->edge[j].weight;
+               if((w > s->delta) != s->heavy) continue;
+               //d is only written between phases, so it can be read here without a lock
+               int target = v->edge[j].target;
+               double distance = s->d[u] + w;
+               if(s->d[target] != -1 && distance >= s->d[target]) continue;
+               if(s->requestCount[t] == s->requestCapacity[t]){
+                    s->requestCapacity[t] = s->requestCapacity[t] * 2 + 16;
+                    s->requests[t] = realloc(s->requests[t], s->requestCapacity[t] * sizeof(request));
+               }
+               s->requests[t][s->requestCount[t]++] = (request){target, u, distance};
+          }
+     }
+}
+
+void stepPhase(stepper *s){
+     //Waking the other threads costs more than a small frontier takes to relax alone
+     if(s->threads == 1 || s->frontierSize < 256){
+          stepRelax(s, 0, 0, s->frontierSize);
+          return;
+     }
+     stepWait(s);
+     stepRelax(s, 0, 0, s->frontierSize / s->threads);
+     stepWait(s);
+}
+
+void *stepWorker(void *arg){
+     stepper *s = arg;
+     //Each worker knows its place from the order it was started in
+#ifndef _WIN32
+     pthread_mutex_lock(&s->lock);
+     int t = ++s->started;
+     pthread_mutex_unlock(&s->lock);
+#else
+     int t = 1;
+#endif
+     while(true){
+          stepWait(s);
+          if(s->done) return NULL;
+          stepRelax(s, t, (long long)s->frontierSize * t / s->threads,
+                    (long long)s->frontierSize * (t + 1) / s->threads);
+          stepWait(s);
+     }
+}
+
+void stepApply(stepper *s, long long current){
+     for(int t = 0; t < s->threads; t++){
+          for(int r = 0; r < s->requestCount[t]; r++){
+               request *q = &s->requests[t][r];
+               int v = q->target;
+               if(s->d[v] != -1 && q->distance >= s->d[v]) continue;
+               s->d[v] = q->distance;
+               s->p[v] = s->n->inventory[q->from]->x;
+               long long bucket = (long long)(q->distance / s->delta);
+               //Rounding must never put a node in a bucket that has already been emptied
+               stepBucket(s, v, bucket < current ? current : bucket);
+          }
+          s->requestCount[t] = 0;
+     }
+}
+
+void stepBucket(stepper *s, int v, long long bucket){
+     if(s->bucketOf[v] == bucket) return;
+     if(s->bucketOf[v] == -1) s->pending++;
+     s->bucketOf[v] = bucket;
+     int b = bucket % s->cycle;
+     if(s->bucketSize[b] == s->bucketCapacity[b]){
+          s->bucketCapacity[b] = s->bucketCapacity[b] * 2 + 4;
+          s->buckets[b] = realloc(s->buckets[b], s->bucketCapacity[b] * sizeof(int));
+     }
+     s->buckets[b][s->bucketSize[b]++] = v;
+}
+
+void stepWait(stepper *s){
+#ifndef _WIN32
+     pthread_mutex_lock(&s->lock);
+     int generation = s->generation;
+     s->arrived++;
+     if(s->arrived == s->threads){
+          s->arrived = 0;
+          s->generation++;
+          pthread_cond_broadcast(&s->wake);
+     }
+     else{
+          while(generation == s->generation) { pthread_cond_wait(&s->wake, &s->lock); }
+     }
+     pthread_mutex_unlock(&s->lock);
+#else
+     (void)s;
+#endif
+}
+
+void allPairsShortest(const network *n, double *dist, item *next, int threads){
+     int size = n->size;
+     if(size == 0) return;
+     size_t cells = (size_t)size * size;
+     tiling t = {.dist = dist, .next = NULL, .size = size};
+     t.blocks = (size + FLOYD_BLOCK - 1) / FLOYD_BLOCK;
+     if(next != NULL) t.next = malloc(cells * sizeof(int));
+     for(size_t c = 0; c < cells; c++) { dist[c] = INFINITY; }
+     if(t.next != NULL) { for(size_t c = 0; c < cells; c++) { t.next[c] = -1; } }
+     for(int i = 0; i < size; i++){
+          size_t row = (size_t)i * size;
+          dist[row + i] = 0;
+          if(t.next != NULL) t.next[row + i] = i;
+          node *v = n->inventory[i];
+          for(int j = 0; j < v->links; j++){
+               int target = v->edge[j].target;
+               if(v->edge[j].weight < dist[row + target]){
+                    dist[row + target] = v->edge[j].weight;
+                    if(t.next != NULL) t.next[row + target] = target;
+               }
+          }
+     }
+#ifdef _WIN32
+     threads = 1;
+#else
+     pthread_mutex_init(&t.lock, NULL);
+#endif
+     if(threads < 1) threads = 1;
+
+     //Each round finishes the tile on the diagonal, then the rest of its row and column,
+     //then every other tile, which only read those
+     for(int k = 0; k < t.blocks; k++){
+          t.k = k;
+          floydTile(&t, k, k, k);
+          t.phase = 2;
+          t.jobs = 2 * (t.blocks - 1);
+          floydPhase(&t, threads);
+          t.phase = 3;
+          t.jobs = (t.blocks - 1) * (t.blocks - 1);
+          floydPhase(&t, threads);
+     }
+#ifndef _WIN32
+     pthread_mutex_destroy(&t.lock);
+#endif
+
+     //Give the results in the same form as dijkstra
+     for(size_t c = 0; c < cells; c++){
+          if(dist[c] == INFINITY) dist[c] = -1;
+     }
+     if(next != NULL){
+          for(size_t c = 0; c < cells; c++){
+               next[c] = (t.next[c] == -1) ? n->null : n->inventory[t.next[c]]->x;
+          }
+          free(t.next);
+     }
+}
+
+void floydPhase(tiling *t, int threads){
+     if(t->jobs == 0) return;
+     t->job = 0;
+     if(threads > t->jobs) threads = t->jobs;
+#ifndef _WIN32
+     pthread_t *workers = malloc(threads * sizeof(pthread_t));
+     //The calling thread is one of the workers, so one fewer is started
+     int started = 0;
+     while(started < threads - 1 && pthread_create(&workers[started], NULL, floydWorker, t) == 0){
+          started++;
+     }
+     floydWorker(t);
+     for(int i = 0; i < started; i++) { pthread_join(workers[i], NULL); }
+     free(workers);
+#else
+     (void)threads;
+     floydWorker(t);
+#endif
+}
+
+void *floydWorker(void *arg){
+     tiling *t = arg;
+     while(true){
+#ifndef _WIN32
+          pthread_mutex_lock(&t->lock);
+#endif
+          int job = t->job;
+          if(job < t->jobs) t->job++;
+#ifndef _WIN32
+          pthread_mutex_unlock(&t->lock);
+#endif
+          if(job >= t->jobs) break;
+          //Number the tiles of the phase, skipping the row and column of the diagonal tile
+          int others = t->blocks - 1;
+          if(t->phase == 2){
+               int b = job % others;
+               if(b >= t->k) b++;
+               if(job < others) floydTile(t, t->k, b, t->k);
+               else floydTile(t, b, t->k, t->k);
+          }
+          else{
+               int ib = job / others, jb = job % others;
+               if(ib >= t->k) ib++;
+               if(jb >= t->k) jb++;
+               floydTile(t, ib, jb, t->k);
+          }
+     }
+     return NULL;
+}
+
+void floydTile(tiling *t, int ib, int jb, int kb){
+     int size = t->size;
+     int i0 = ib * FLOYD_BLOCK, j0 = jb * FLOYD_BLOCK, k0 = kb * FLOYD_BLOCK;
+     int i1 = (i0 + FLOYD_BLOCK < size) ? i0 + FLOYD_BLOCK : size;
+     int j1 = (j0 + FLOYD_BLOCK < size) ? j0 + FLOYD_BLOCK : size;
+     int k1 = (k0 + FLOYD_BLOCK < size) ? k0 + FLOYD_BLOCK : size;
+     for(int k = k0; k < k1; k++){
+          const double *through = t->dist + (size_t)k * size;
+          for(int i = i0; i < i1; i++){
+               double *row = t->dist + (size_t)i * size;
+               double first = row[k];
+               if(first == INFINITY) continue;
+               //The inner loops have no branches, so the compiler can turn them into vector instructions
+               if(t->next == NULL){
+                    for(int j = j0; j < j1; j++){
+                         double w = first + through[j];
+                         row[j] = (w < row[j]) ? w : row[j];
+                    }
+               }
+               else{
+                    int *hops = t->next + (size_t)i * size;
+                    int hop = hops[k];
+                    for(int j = j0; j < j1; j++){
+                         double w = first + through[j];
+                         bool shorter = w < row[j];
+                         row[j] = shorter ? w : row[j];
+                         hops[j] = shorter ? hop : hops[j];
+                    }
+               }
+          }
+     }
+}
+
+double getShortestDistance(network *n, item y, double *d){
+     int index = getSlot(n, y);
+     if(index == -1) return -1;
+     return d[index];
 }
 
 void getShortestPath(network *n, item y, item *p, item *path){
      for(int i = 0; i < n->size; i++) { path[i] = n->null; }
-     int index = getIndex(n->size, n->inventory, y);
+     int index = getSlot(n, y);
      if(index == -1) return;
 
      int i = 0;
@@ -689,23 +2436,734 @@ void getShortestPath(network *n, item y, item *p, item *path){
           if(i != 0 && n->inventory[index]->x == path[i - 1]) return;
           path[i] = n->inventory[index]->x; i++;
 
-          index = getIndex(n->size, n->inventory, p[index]);
+          index = getSlot(n, p[index]);
           if(index == -1) return;
      }
 }
 
-void swap(int i, int j, node **arr){
-     node *temp = arr[i];
-     arr[i] = arr[j];
-     arr[j] = temp;
+double shortestPath(network *n, item src, item dst, item *path, int *len){
+     *len = 0;
+     int from = getSlot(n, src), to = getSlot(n, dst);
+     if(from == -1 || to == -1) return -1;
+     searcher *s = searchReserve(n);
+     double *d = s->d[0];
+     int *prev = s->prev[0];
+     heap *h = s->h[0];
+     h->key = d;
+     d[from] = 0;
+     prev[from] = -1;
+     s->touched[s->touchedCount++] = from;
+     heapPush(h, from);
+     while(!heapEmpty(h)){
+          int u = heapPop(h);
+          //Once the target leaves the heap its distance is final
+          if(u == to) break;
+          node *current = n->inventory[u];
+          for(int i = 0; i < current->links; i++){
+               int v = current->edge[i].target;
+               double w = d[u] + current->edge[i].weight;
+               if(d[v] == -1){
+                    d[v] = w; prev[v] = u;
+                    s->touched[s->touchedCount++] = v;
+                    heapPush(h, v);
+               }
+               else if(w < d[v]){
+                    d[v] = w; prev[v] = u;
+                    heapDecrease(h, v);
+               }
+          }
+     }
+
+     double distance = d[to];
+     if(distance != -1) *len = tracePath(n, prev, to, path);
+     searchReset(s);
+     return distance;
+}
+
+double bidirectionalPath(network *n, item src, item dst, item *path, int *len){
+     *len = 0;
+     int from = getSlot(n, src), to = getSlot(n, dst);
+     if(from == -1 || to == -1) return -1;
+     //Side 0 searches forwards from src, and side 1 backwards from dst
+     searcher *s = searchReserve(n);
+     double *d = s->d[0], *back = s->d[1];
+     int *prev = s->prev[0], *next = s->prev[1];
+     heap *forward = s->h[0], *backward = s->h[1];
+     forward->key = d;
+     backward->key = back;
+     d[from] = 0; prev[from] = -1;
+     back[to] = 0; next[to] = -1;
+     s->touched[s->touchedCount++] = from;
+     if(to != from) s->touched[s->touchedCount++] = to;
+     double best = (from == to) ? 0 : -1;
+     int meet = (from == to) ? from : -1;
+
+     heapPush(forward, from);
+     heapPush(backward, to);
+     while(!heapEmpty(forward) && !heapEmpty(backward)){
+          //No path through a node still in either heap can be shorter than the best one found
+          double lowest = d[forward->slots[0]] + back[backward->slots[0]];
+          if(best != -1 && lowest >= best) break;
+          //Move on whichever side has fewer nodes waiting
+          if(forward->size <= backward->size) searchStep(n, s, 0, &best, &meet);
+          else searchStep(n, s, 1, &best, &meet);
+     }
+
+     if(meet != -1){
+          *len = tracePath(n, prev, meet, path);
+          for(int i = next[meet]; i != -1; i = next[i]) { path[(*len)++] = n->inventory[i]->x; }
+     }
+     searchReset(s);
+     return best;
+}
+
+void searchStep(const network *n, searcher *s, int side, double *best, int *meet){
+     heap *h = s->h[side];
+     double *d = s->d[side], *other = s->d[1 - side];
+     int *prev = s->prev[side];
+     int u = heapPop(h);
+     node *current = n->inventory[u];
+     int count = (side == 1) ? current->parentCount : current->links;
+     for(int i = 0; i < count; i++){
+          int v;
+          double w;
+          if(side == 0){
+               v = current->edge[i].target;
+               w = current->edge[i].weight;
+          }
+          else{
+               v = current->parents[i];
+               node *parent = n->inventory[v];
+               w = parent->edge[current->parentEdge[i]].weight;
+          }
+          w += d[u];
+          if(d[v] == -1){
+               //A slot reached by the other side already is on the touched list
+               if(other[v] == -1) s->touched[s->touchedCount++] = v;
+               d[v] = w; prev[v] = u;
+               heapPush(h, v);
+          }
+          else if(w < d[v]){
+               d[v] = w; prev[v] = u;
+               heapDecrease(h, v);
+          }
+          else continue;
+          if(other[v] != -1 && (*best == -1 || d[v] + other[v] < *best)){
+               *best = d[v] + other[v];
+               *meet = v;
+          }
+     }
+}
+
+double astar(network *n, item src, item dst, double (*h)(item, item, void *), void *ctx, item *path, int *len){
+     *len = 0;
+     int from = getSlot(n, src), to = getSlot(n, dst);
+     if(from == -1 || to == -1) return -1;
+     //g is the distance found so far, and the heap is ordered by f - g plus the estimate to dst
+     searcher *s = searchReserve(n);
+     double *g = s->d[0], *f = s->f;
+     int *prev = s->prev[0];
+     heap *open = s->h[0];
+     open->key = f;
+     g[from] = 0;
+     prev[from] = -1;
+     f[from] = (h == NULL) ? 0 : h(src, dst, ctx);
+     s->touched[s->touchedCount++] = from;
+     heapPush(open, from);
+     while(!heapEmpty(open)){
+          int u = heapPop(open);
+          if(u == to) break;
+          node *current = n->inventory[u];
+          for(int i = 0; i < current->links; i++){
+               int v = current->edge[i].target;
+               double w = g[u] + current->edge[i].weight;
+               if(g[v] != -1 && w >= g[v]) continue;
+               if(g[v] == -1) s->touched[s->touchedCount++] = v;
+               g[v] = w; prev[v] = u;
+               f[v] = w + ((h == NULL) ? 0 : h(n->inventory[v]->x, dst, ctx));
+               //A node that has already left the heap goes back in if a shorter way to it turns up,
+               //which can only happen when the estimate is not consistent
+               if(open->pos[v] == -1) heapPush(open, v);
+               else heapDecrease(open, v);
+          }
+     }
+
+     double distance = g[to];
+     if(distance != -1) *len = tracePath(n, prev, to, path);
+     searchReset(s);
+     return distance;
+}
+
+searcher *searchReserve(network *n){
+     searcher *s = n->search;
+     if(s == NULL){
+          s = malloc(sizeof(searcher));
+          s->capacity = 0;
+          s->touchedCount = 0;
+          for(int k = 0; k < 2; k++){
+               s->d[k] = NULL;
+               s->prev[k] = NULL;
+               s->h[k] = newHeap(0, NULL);
+          }
+          s->f = NULL;
+          s->touched = NULL;
+          n->search = s;
+     }
+     if(n->size <= s->capacity) return s;
+     int capacity = s->capacity * GROWTH_RATE + 1;
+     if(capacity < n->size) capacity = n->size;
+     for(int k = 0; k < 2; k++){
+          s->d[k] = realloc(s->d[k], (capacity + 1) * sizeof(double));
+          s->prev[k] = realloc(s->prev[k], (capacity + 1) * sizeof(int));
+          //The heaps are empty between searches, so only their arrays need to grow
+          s->h[k]->slots = realloc(s->h[k]->slots, (capacity + 1) * sizeof(int));
+          s->h[k]->pos = realloc(s->h[k]->pos, (capacity + 1) * sizeof(int));
+          for(int i = s->capacity; i < capacity; i++) { s->d[k][i] = -1; s->h[k]->pos[i] = -1; }
+     }
+     s->f = realloc(s->f, (capacity + 1) * sizeof(double));
+     s->touched = realloc(s->touched, (capacity + 1) * sizeof(int));
+     s->capacity = capacity;
+     return s;
+}
+
+void searchReset(searcher *s){
+     for(int i = 0; i < s->touchedCount; i++){
+          int v = s->touched[i];
+          for(int k = 0; k < 2; k++) { s->d[k][v] = -1; s->h[k]->pos[v] = -1; }
+     }
+     s->touchedCount = 0;
+     s->h[0]->size = 0;
+     s->h[1]->size = 0;
+}
+
+void freeSearcher(searcher *s){
+     for(int k = 0; k < 2; k++){
+          free(s->d[k]);
+          free(s->prev[k]);
+          freeHeap(s->h[k]);
+     }
+     free(s->f);
+     free(s->touched);
+     free(s);
+}
+
+int tracePath(const network *n, const int *prev, int slot, item *path){
+     int count = 0;
+     for(int i = slot; i != -1; i = prev[i]) { count++; }
+     int k = count;
+     for(int i = slot; i != -1; i = prev[i]) { path[--k] = n->inventory[i]->x; }
+     return count;
 }
 
-void sort(int size, node **arr){
-     if(size <= 1) return;
-     for(int i = 0; i < size - 1; i++){
-          if(arr[i]->x > arr[i + 1]->x) swap(i, i + 1, arr);
+bool trackShortestPaths(network *n, item root){
+     int slot = getSlot(n, root);
+     if(slot == -1) return false;
+     stopTracking(n);
+     tracker *t = malloc(sizeof(tracker));
+     t->root = slot;
+     t->capacity = n->size;
+     t->d = malloc((t->capacity + 1) * sizeof(double));
+     t->prev = malloc((t->capacity + 1) * sizeof(int));
+     t->p = malloc((t->capacity + 1) * sizeof(item));
+     t->lost = malloc((t->capacity + 1) * sizeof(int));
+     t->lostCount = 0;
+     t->h = newHeap(t->capacity, t->d);
+     n->tracked = t;
+     for(int i = 0; i < n->size; i++){
+          t->d[i] = -1;
+          t->prev[i] = -1;
+          t->p[i] = n->null;
+     }
+     //The first run is an ordinary dijkstra, spreading from the root
+     t->d[slot] = 0;
+     heapPush(t->h, slot);
+     trackSpread(n);
+     return true;
+}
+
+void stopTracking(network *n){
+     tracker *t = n->tracked;
+     if(t == NULL) return;
+     free(t->d); free(t->prev); free(t->p); free(t->lost);
+     freeHeap(t->h);
+     free(t);
+     n->tracked = NULL;
+}
+
+bool trackedPaths(network *n, const double **d, const item **p){
+     if(n->tracked == NULL) { *d = NULL; *p = NULL; return false; }
+     *d = n->tracked->d;
+     *p = n->tracked->p;
+     return true;
+}
+
+void trackReserve(network *n){
+     tracker *t = n->tracked;
+     if(n->size <= t->capacity) return;
+     int capacity = t->capacity * GROWTH_RATE + 1;
+     if(capacity < n->size) capacity = n->size;
+     t->d = realloc(t->d, (capacity + 1) * sizeof(double));
+     t->prev = realloc(t->prev, (capacity + 1) * sizeof(int));
+     t->p = realloc(t->p, (capacity + 1) * sizeof(item));
+     t->lost = realloc(t->lost, (capacity + 1) * sizeof(int));
+     //The heap is empty between changes, so only its arrays need to grow
+     t->h->key = t->d;
+     t->h->slots = realloc(t->h->slots, (capacity + 1) * sizeof(int));
+     t->h->pos = realloc(t->h->pos, (capacity + 1) * sizeof(int));
+     for(int i = t->capacity; i < capacity; i++) { t->h->pos[i] = -1; }
+     t->capacity = capacity;
+}
+
+void trackLower(network *n, int u, int v, double w){
+     tracker *t = n->tracked;
+     if(t->d[u] == -1) return;
+     double distance = t->d[u] + w;
+     if(t->d[v] != -1 && distance >= t->d[v]) return;
+     t->d[v] = distance;
+     t->prev[v] = u;
+     t->p[v] = n->inventory[u]->x;
+     heapPush(t->h, v);
+     trackSpread(n);
+}
+
+void trackSpread(network *n){
+     tracker *t = n->tracked;
+     while(!heapEmpty(t->h)){
+          int u = heapPop(t->h);
+          node *current = n->inventory[u];
+          for(int i = 0; i < current->links; i++){
+               int v = current->edge[i].target;
+               double w = t->d[u] + current->edge[i].weight;
+               if(t->d[v] != -1 && w >= t->d[v]) continue;
+               t->d[v] = w;
+               t->prev[v] = u;
+               t->p[v] = current->x;
+               //A node can come back after leaving the heap if the change made it closer again
+               if(t->h->pos[v] == -1) heapPush(t->h, v);
+               else heapDecrease(t->h, v);
+          }
+     }
+}
+
+void trackCut(network *n, int v){
+     tracker *t = n->tracked;
+     if(t->d[v] == -1) return;
+     //The lost list doubles as the queue of the walk down the tree of shortest paths
+     int start = t->lostCount;
+     t->lost[t->lostCount++] = v;
+     t->d[v] = -1;
+     for(int k = start; k < t->lostCount; k++){
+          int u = t->lost[k];
+          node *current = n->inventory[u];
+          for(int i = 0; i < current->links; i++){
+               int c = current->edge[i].target;
+               if(t->d[c] != -1 && t->prev[c] == u){
+                    t->d[c] = -1;
+                    t->lost[t->lostCount++] = c;
+               }
+          }
+          t->prev[u] = -1;
+          t->p[u] = n->null;
+     }
+}
+
+void trackRepair(network *n){
+     tracker *t = n->tracked;
+     for(int k = 0; k < t->lostCount; k++){
+          int v = t->lost[k];
+          node *current = n->inventory[v];
+          for(int i = 0; i < current->parentCount; i++){
+               int u = current->parents[i];
+               if(t->d[u] == -1) continue;
+               node *parent = n->inventory[u];
+               double w = t->d[u] + parent->edge[current->parentEdge[i]].weight;
+               if(t->d[v] == -1 || w < t->d[v]){
+                    t->d[v] = w;
+                    t->prev[v] = u;
+                    t->p[v] = parent->x;
+               }
+          }
+          if(t->d[v] != -1) heapPush(t->h, v);
+     }
+     t->lostCount = 0;
+     trackSpread(n);
+}
+
+void trackRemove(network *n, int index, int last){
+     tracker *t = n->tracked;
+     if(t->root == index) t->root = -1;
+     //The deleted node was cut with everything below it, and is not given a distance again
+     int kept = 0;
+     for(int k = 0; k < t->lostCount; k++){
+          if(t->lost[k] != index) t->lost[kept++] = t->lost[k];
+     }
+     t->lostCount = kept;
+     if(index != last){
+          t->d[index] = t->d[last];
+          t->prev[index] = t->prev[last];
+          t->p[index] = t->p[last];
+          if(t->root == last) t->root = index;
+          for(int k = 0; k < t->lostCount; k++){
+               if(t->lost[k] == last) t->lost[k] = index;
+          }
+          //Only the nodes the moved node leads to can have it as their previous node
+          node *moved = n->inventory[index];
+          for(int i = 0; i < moved->links; i++){
+               int v = moved->edge[i].target;
+               if(t->prev[v] == last) t->prev[v] = index;
+          }
+     }
+     trackRepair(n);
+}
+
+void trackPermute(network *n, const int *moved){
+     tracker *t = n->tracked;
+     double *d = malloc((t->capacity + 1) * sizeof(double));
+     int *prev = malloc((t->capacity + 1) * sizeof(int));
+     item *p = malloc((t->capacity + 1) * sizeof(item));
+     for(int i = 0; i < n->size; i++){
+          d[moved[i]] = t->d[i];
+          prev[moved[i]] = (t->prev[i] == -1) ? -1 : moved[t->prev[i]];
+          p[moved[i]] = t->p[i];
+     }
+     if(t->root != -1) t->root = moved[t->root];
+     free(t->d); free(t->prev); free(t->p);
+     t->d = d;
+     t->prev = prev;
+     t->p = p;
+     t->h->key = d;
+}
+
+frozen *freezeNetwork(network *n){
+     frozen *f = malloc(sizeof(frozen));
+     f->size = n->size;
+     f->null = n->null;
+     f->root = (n->root == NULL) ? -1 : getSlot(n, n->root->x);
+     f->items = malloc((n->size + 1) * sizeof(item));
+     f->offsets = malloc((n->size + 1) * sizeof(int));
+
+     //Lay out each node's edges one after another
+     f->offsets[0] = 0;
+     for(int i = 0; i < n->size; i++){
+          f->items[i] = n->inventory[i]->x;
+          f->offsets[i + 1] = f->offsets[i] + n->inventory[i]->links;
+     }
+     f->edges = f->offsets[n->size];
+     f->targets = malloc((f->edges + 1) * sizeof(int));
+     f->weights = malloc((f->edges + 1) * sizeof(double));
+     for(int i = 0; i < n->size; i++){
+          node *v = n->inventory[i];
+          int e = f->offsets[i];
+          for(int j = 0; j < v->links; j++){
+               f->targets[e + j] = v->edge[j].target;
+               f->weights[e + j] = v->edge[j].weight;
+          }
+     }
+
+     f->bucketCount = n->bucketCount;
+     f->buckets = malloc(n->bucketCount * sizeof(int));
+     memcpy(f->buckets, n->buckets, n->bucketCount * sizeof(int));
+     f->mapping = NULL;
+     f->mappingLength = 0;
+     return f;
+}
+
+void freeFrozen(frozen *f){
+     if(f->mapping != NULL){
+          unmapFile(f->mapping, f->mappingLength);
+          free(f);
+          return;
+     }
+     free(f->items);
+     free(f->offsets);
+     free(f->targets);
+     free(f->weights);
+     free(f->buckets);
+     free(f);
+}
+
+int frozenNodes(frozen *f){
+     return f->size;
+}
+
+item frozenItem(frozen *f, int i){
+     if(i < 0 || i >= f->size) return f->null;
+     return f->items[i];
+}
+
+int frozenSlot(frozen *f, item x){
+     int b = hashItem(x, f->bucketCount);
+     while(f->buckets[b] != -1){
+          if(f->items[f->buckets[b]] == x) return f->buckets[b];
+          b = (b + 1) & (f->bucketCount - 1);
+     }
+     return -1;
+}
+
+bool frozenContains(frozen *f, int u, int v){
+     for(int e = f->offsets[u]; e < f->offsets[u + 1]; e++){
+          if(f->targets[e] == v) return true;
      }
-     sort(size - 1, arr);
+     return false;
+}
+
+bool frozenDepthFirstSearch(frozen *f, item x){
+     if(f->root == -1) return false;
+     int target = frozenSlot(f, x);
+     if(target == -1) return false;
+
+     //Nodes are marked when pushed, so each is pushed at most once
+     bool *visited = calloc(f->size, sizeof(bool));
+     int *stack = malloc(f->size * sizeof(int));
+     int top = 0;
+     stack[top++] = f->root; visited[f->root] = true;
+     bool found = false;
+     while(top > 0 && !found){
+          int u = stack[--top];
+          if(u == target) found = true;
+          for(int e = f->offsets[u]; e < f->offsets[u + 1]; e++){
+               int v = f->targets[e];
+               if(!visited[v]) { visited[v] = true; stack[top++] = v; }
+          }
+     }
+     free(visited);
+     free(stack);
+     return found;
+}
+
+bool frozenBreadthFirstSearch(frozen *f, item x){
+     if(f->root == -1) return false;
+     int target = frozenSlot(f, x);
+     if(target == -1) return false;
+
+     bool *visited = calloc(f->size, sizeof(bool));
+     queue *q = newQueue(f->size);
+     enqueue(q, f->root); visited[f->root] = true;
+     bool found = false;
+     while(!queueEmpty(q) && !found){
+          int u = dequeue(q);
+          if(u == target) found = true;
+          for(int e = f->offsets[u]; e < f->offsets[u + 1]; e++){
+               int v = f->targets[e];
+               if(!visited[v]) { visited[v] = true; enqueue(q, v); }
+          }
+     }
+     free(visited);
+     freeQueue(q);
+     return found;
+}
+
+void frozenDijkstra(frozen *f, double *d, item *p){
+     for(int i = 0; i < f->size; i++){
+          d[i] = -1;
+          p[i] = f->null;
+     }
+     if(f->root == -1) return;
+
+     d[f->root] = 0;
+     heap *h = newHeap(f->size, d);
+     heapPush(h, f->root);
+     while(!heapEmpty(h)){
+          int u = heapPop(h);
+          for(int e = f->offsets[u]; e < f->offsets[u + 1]; e++){
+               int v = f->targets[e];
+               double w = d[u] + f->weights[e];
+               if(d[v] == -1){
+                    d[v] = w; p[v] = f->items[u];
+                    heapPush(h, v);
+               }
+               else if(w < d[v]){
+                    d[v] = w; p[v] = f->items[u];
+                    heapDecrease(h, v);
+               }
+          }
+     }
+     freeHeap(h);
+}
+
+bool frozenIsSubNet(frozen *f, network *m){
+     if(f->size == 0 || empty(m)) return false;
+     for(int i = 0; i < m->size; i++){
+          node *mNode = m->inventory[i];
+          int u = frozenSlot(f, mNode->x);
+          if(u == -1) return false;
+          for(int j = 0; j < mNode->links; j++){
+               int v = frozenSlot(f, m->inventory[mNode->edge[j].target]->x);
+               if(v == -1 || !frozenContains(f, u, v)) return false;
+          }
+     }
+     return true;
+}
+
+size_t fileLayout(fileHeader *h, size_t sections[5]){
+     //The header is padded to a multiple of 8 bytes so the weights that follow are aligned
+     size_t pos = (sizeof(fileHeader) + 7) / 8 * 8;
+     sections[0] = pos; pos += (size_t)h->edges * sizeof(double);
+     sections[1] = pos; pos += (size_t)h->size * sizeof(item);
+     sections[2] = pos; pos += ((size_t)h->size + 1) * sizeof(int);
+     sections[3] = pos; pos += (size_t)h->edges * sizeof(int);
+     sections[4] = pos; pos += (size_t)h->bucketCount * sizeof(int);
+     return pos;
+}
+
+bool saveNetwork(network *n, const char *path){
+     FILE *file = fopen(path, "wb");
+     if(file == NULL) return false;
+     frozen *f = freezeNetwork(n);
+
+     fileHeader h;
+     memset(&h, 0, sizeof(h));
+     memcpy(h.magic, "NETW", 4);
+     h.version = 1;
+     h.itemSize = sizeof(item);
+     h.size = f->size;
+     h.edges = f->edges;
+     h.root = f->root;
+     h.bucketCount = f->bucketCount;
+     h.null = f->null;
+     size_t sections[5];
+     fileLayout(&h, sections);
+
+     char padding[8] = {0};
+     bool ok = fwrite(&h, sizeof(h), 1, file) == 1;
+     ok = ok && fwrite(padding, 1, sections[0] - sizeof(h), file) == sections[0] - sizeof(h);
+     ok = ok && fwrite(f->weights, sizeof(double), f->edges, file) == (size_t)f->edges;
+     ok = ok && fwrite(f->items, sizeof(item), f->size, file) == (size_t)f->size;
+     ok = ok && fwrite(f->offsets, sizeof(int), f->size + 1, file) == (size_t)f->size + 1;
+     ok = ok && fwrite(f->targets, sizeof(int), f->edges, file) == (size_t)f->edges;
+     ok = ok && fwrite(f->buckets, sizeof(int), f->bucketCount, file) == (size_t)f->bucketCount;
+     if(fclose(file) != 0) ok = false;
+     freeFrozen(f);
+     return ok;
+}
+
+char *mapFile(const char *path, size_t *length){
+#ifndef _WIN32
+     FILE *file = fopen(path, "rb");
+     if(file == NULL) return NULL;
+     struct stat st;
+     if(fstat(fileno(file), &st) == -1 || st.st_size == 0) { fclose(file); return NULL; }
+     *length = st.st_size;
+     char *mapping = mmap(NULL, *length, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+     //The mapping stays valid after the file is closed
+     fclose(file);
+     if(mapping == MAP_FAILED) return NULL;
+     return mapping;
+#else
+     FILE *file = fopen(path, "rb");
+     if(file == NULL) return NULL;
+     fseek(file, 0, SEEK_END);
+     long end = ftell(file);
+     rewind(file);
+     if(end <= 0) { fclose(file); return NULL; }
+     *length = end;
+     char *mapping = malloc(*length);
+     if(fread(mapping, 1, *length, file) != *length) { free(mapping); mapping = NULL; }
+     fclose(file);
+     return mapping;
+#endif
+}
+
+void unmapFile(char *mapping, size_t length){
+#ifndef _WIN32
+     munmap(mapping, length);
+#else
+     (void)length;
+     free(mapping);
+#endif
+}
+
+frozen *loadNetwork(const char *path){
+     size_t length;
+     char *mapping = mapFile(path, &length);
+     if(mapping == NULL) return NULL;
+
+     //Check the header before trusting any of the counts in it
+     fileHeader h;
+     size_t sections[5];
+     bool valid = length >= sizeof(h);
+     if(valid){
+          memcpy(&h, mapping, sizeof(h));
+          valid = memcmp(h.magic, "NETW", 4) == 0 && h.version == 1 && h.itemSize == (int)sizeof(item);
+          valid = valid && h.size >= 0 && h.edges >= 0 && h.bucketCount > 0;
+          valid = valid && (h.bucketCount & (h.bucketCount - 1)) == 0;
+          valid = valid && h.root >= -1 && h.root < h.size;
+     }
+     if(valid) valid = fileLayout(&h, sections) == length;
+     if(!valid){
+          unmapFile(mapping, length);
+          return NULL;
+     }
+
+     frozen *f = malloc(sizeof(frozen));
+     f->size = h.size;
+     f->edges = h.edges;
+     f->null = h.null;
+     f->root = h.root;
+     f->bucketCount = h.bucketCount;
+     f->weights = (double*)(mapping + sections[0]);
+     f->items = (item*)(mapping + sections[1]);
+     f->offsets = (int*)(mapping + sections[2]);
+     f->targets = (int*)(mapping + sections[3]);
+     f->buckets = (int*)(mapping + sections[4]);
+     f->mapping = mapping;
+     f->mappingLength = length;
+     if(!checkFrozen(f)){
+          freeFrozen(f);
+          return NULL;
+     }
+     return f;
+}
+
+bool checkFrozen(frozen *f){
+     if(f->offsets[0] != 0 || f->offsets[f->size] != f->edges) return false;
+     if(f->bucketCount <= f->size) return false;
+     for(int i = 0; i < f->size; i++){
+          if(f->offsets[i + 1] < f->offsets[i]) return false;
+     }
+     for(int e = 0; e < f->edges; e++){
+          if(f->targets[e] < 0 || f->targets[e] >= f->size) return false;
+          //Written this way round so that NaN is rejected too
+          if(!(f->weights[e] >= 0)) return false;
+     }
+     //Without an empty bucket, looking up a missing item would never stop
+     int used = 0;
+     for(int b = 0; b < f->bucketCount; b++){
+          if(f->buckets[b] < -1 || f->buckets[b] >= f->size) return false;
+          if(f->buckets[b] != -1) used++;
+     }
+     return used < f->bucketCount;
+}
+
+int compareNodes(const void *a, const void *b){
+     item x = (*(node *const *)a)->x, y = (*(node *const *)b)->x;
+     return (x > y) - (x < y);
+}
+
+void sortInventory(network *n){
+     int i = 1;
+     while(i < n->size && n->inventory[i - 1]->x < n->inventory[i]->x) { i++; }
+     if(i >= n->size) return;
+     //Cached results are stored by slot, which is about to change
+     n->version++;
+
+     //Remember where each node was, to find where its edges' targets have moved to
+     node **before = malloc((n->size + 1) * sizeof(node*));
+     memcpy(before, n->inventory, n->size * sizeof(node*));
+     qsort(n->inventory, n->size, sizeof(node*), compareNodes);
+     rebuildIndex(n);
+
+     int *moved = malloc((n->size + 1) * sizeof(int));
+     for(int i = 0; i < n->size; i++) { moved[i] = getSlot(n, before[i]->x); }
+     for(int i = 0; i < n->size; i++){
+          node *v = n->inventory[i];
+          for(int j = 0; j < v->links; j++) { v->edge[j].target = moved[v->edge[j].target]; }
+          indexEdges(n, v);
+     }
+     rebuildParents(n);
+     if(n->tracked != NULL) trackPermute(n, moved);
+     free(before);
+     free(moved);
 }
 
 void printDijkstra(network *n, double *d, item *p){
@@ -729,15 +3187,15 @@ void printDijkstra(network *n, double *d, item *p){
      }
 }
 
-void printNodeList(node *n){
-     int len = n->links;
+void printNodeList(network *n, node *current){
+     int len = current->links;
      //Name of current list
-     printf("%d: {", n->x);
+     printf("%d: {", current->x);
      if(len == 0) printf("}\n");
 
      for(int i = 0; i < len; i++){
           //Prints destination node followed by edge weight
-          printf("%d : %.2f", (n->edge[i])->x, n->weight[i]);
+          printf("%d : %.2f", n->inventory[current->edge[i].target]->x, current->edge[i].weight);
           if(i == len - 1) printf("}\n");
           else printf(", ");
      }
@@ -745,9 +3203,9 @@ void printNodeList(node *n){
 
 void printList(network *n){
      if(empty(n)) return;
-     sort(n->size, n->inventory);
+     sortInventory(n);
      for(int i = 0; i < n->size; i++){
-          printNodeList(n->inventory[i]);
+          printNodeList(n, n->inventory[i]);
      }
 }
 
@@ -755,11 +3213,10 @@ void printNodeMatrix(network *n, node *current){
      //Row name
      printf("%d |", current->x);
      for(int i = 0; i < n->size; i++){
-          node *neighbour = n->inventory[i];
-          //If current points to neighbour
-          if(contains(current->links, current->edge, neighbour->x)){
-               int weightIndex = getIndex(current->links, current->edge, neighbour->x);
-               double w = current->weight[weightIndex];
+          int weightIndex = findEdge(current, i);
+          //If current points to the node in slot i
+          if(weightIndex != -1){
+               double w = current->edge[weightIndex].weight;
                //Print weight of connection
                printf("%.2f|", w);
           }
@@ -773,7 +3230,7 @@ void printNodeMatrix(network *n, node *current){
 
 void printMatrix(network *n){
      if(empty(n)) return;
-     sort(n->size, n->inventory);
+     sortInventory(n);
      int len = n->size;
      //Print the line of column names
      printf("__|");
@@ -790,6 +3247,7 @@ void printMatrix(network *n){
 //Testing and main function
 //Not read when using network as an API
 #ifdef test_network
+#include <time.h>
 
 void printInformation(network *n){
      if(empty(n)) { printf("This network is empty.\n"); return; }
@@ -801,63 +3259,529 @@ void printInformation(network *n){
      else { printf("acyclic\n"); }
 
      //Sort before printing to make it easier to read - values in ascending order
-     sort(n->size, n->inventory);
+     sortInventory(n);
+
+     printf("\nAs an adjacency list: \n");
+     printList(n); printf("\n");
+
+     printf("As an adjacency matrix: \n");
+     printMatrix(n); printf("\n");
+
+     printf("Shortest path from root:\n");
+     double d[n->size];
+     item p[n->size];
+     dijkstra(n, d, p);
+     printDijkstra(n, d, p);
+}
+
+void testNewNetwork(){
+     network *n = newNetwork(-1);
+     assert(n->current == NULL);
+     assert(n->null == -1);
+     freeNetwork(n);
+}
+
+void testAddNode(){
+     network *n = newNetwork(-1);
+     //Add to empty list
+     assert(addNode(n, 5));
+     assert(n->current->x == 5);
+     //Add to non-empty list
+     assert(addNode(n, 4));
+     assert(n->current->x == 4);
+     //Add invalid value
+     assert(addNode(n, 4) == false);
+     //Add null value
+     assert(addNode(n, -1) == false);
+
+     freeNetwork(n);
+}
+
+void testDeleteNode(){
+     network *n = newNetworkFromString("1-2,2-3,3-1", -1);
+     assert(get(n) == 1 && getRoot(n) == 1);
+     //Doesn't delete nodes not in n
+     assert(!deleteNode(n, 4));
+     //Does delete nodes inside n
+     assert(deleteNode(n, 1));
+     //New node is the first one in inventory (n->inventory[0])
+     //The last node, 3, has been moved into the deleted node's slot
+     //Root has been deleted, so getRoot returns null
+     assert(get(n) == 3 && getRoot(n) == -1);
+     //Make sure edges to 1 are deleted
+     assert(find(n, 3)->links == 0);
+     //Edges to nodes that moved down a slot still lead to them
+     n->current = find(n, 2);
+     assert(getWeight(n, 3) == 1 && traverse(n, 3) && get(n) == 3);
+     //Make sure size is updated
+     assert(nodes(n) == 2);
+     //Make sure network can be emptied
+     assert(deleteNode(n, 2));
+     assert(deleteNode(n, 3));
+     assert(empty(n));
+
+     freeNetwork(n);
+}
+
+void testNewNetworkFromEdges(){
+     item src[] = {1, 1, 2, 3, 1, 4, -1, 2, 5};
+     item dst[] = {2, 3, 3, 4, 2, 4, 1, 6, 5};
+     double w[] = {1, 4, 5, 1.5, 9, 2, 1, -3, 1};
+     network *n = newNetworkFromEdges(src, dst, w, 9, -1);
+     //-1 is the null value and 2-6 has a negative weight, so neither edge is added
+     assert(nodes(n) == 5);
+     assert(get(n) == 1 && getRoot(n) == 1);
+     //The repeated 1-2 edge keeps its first weight
+     assert(edges(n) == 2 && getWeight(n, 2) == 1 && getWeight(n, 3) == 4);
+     traverse(n, 3);
+     assert(getWeight(n, 4) == 1.5);
+     traverse(n, 4);
+     assert(getWeight(n, 4) == 2);
+
+     //Builds the same network as the equivalent string
+     network *m = newNetworkFromString("1-2,1-3/4,2-3/5,3-4/1.5,4-4/2,5-5", -1);
+     assert(isSubNet(n, m) && isSubNet(m, n));
+     freeNetwork(m);
+
+     //Nodes made in bulk can still be linked normally
+     n->current = find(n, 5);
+     for(int i = 1; i <= 4; i++) { assert(link(n, i, 1)); }
+     assert(edges(n) == 5);
+     freeNetwork(n);
+
+     //Weights default to 1
+     n = newNetworkFromEdges(src, dst, NULL, 2, -1);
+     assert(getWeight(n, 3) == 1);
+     freeNetwork(n);
+
+     assert(newNetworkFromEdges(src, dst, w, 0, -1) == NULL);
+}
+
+void testNewNetworkArena(){
+     network *n = newNetworkArena(-1);
+     assert(empty(n) && n->slabs == NULL);
+     //Enough edges on one node to grow its arrays several times
+     for(int i = 0; i < 100; i++) { addNode(n, i); }
+     n->current = find(n, 0);
+     for(int i = 1; i < 100; i++) { assert(link(n, i, i)); }
+     assert(edges(n) == 99 && getWeight(n, 1) == 1 && getWeight(n, 99) == 99);
+     assert(n->slabs != NULL && n->slabs->next == NULL);
+
+     //Deleted nodes stay in their slab until the network is freed
+     assert(deleteNode(n, 50));
+     n->current = find(n, 0);
+     assert(edges(n) == 98 && getWeight(n, 50) == -1 && getWeight(n, 51) == 51);
+
+     double d[99];
+     item p[99];
+     dijkstra(n, d, p);
+     assert(getShortestDistance(n, 99, d) == 99);
+
+     //Filling more than one slab
+     for(int i = 100; i < 50000; i++) { addNode(n, i); }
+     assert(n->slabs->next != NULL);
+     freeNetwork(n);
+
+     item src[] = {1, 2, 3}, dst[] = {2, 3, 1};
+     n = newNetworkFromEdges(src, dst, NULL, 3, -1);
+     assert(isCyclic(n));
+     freeNetwork(n);
+}
+
+//Checks every edge is in its target's list of parents, and every parent has an edge
+void checkParents(network *n){
+     int edgeCount = 0, parentCount = 0;
+     for(int i = 0; i < n->size; i++){
+          node *v = n->inventory[i];
+          edgeCount += v->links;
+          parentCount += v->parentCount;
+          for(int j = 0; j < v->parentCount; j++){
+               node *m = n->inventory[v->parents[j]];
+               assert(findEdge(m, i) == v->parentEdge[j] && m->edge[v->parentEdge[j]].back == j);
+          }
+          for(int j = 0; j < v->links; j++) { assert(findEdge(v, v->edge[j].target) == j); }
+     }
+     assert(edgeCount == parentCount);
+}
+
+void testDeleteNodeParents(){
+     //Self loops, edges to and from the last node, and a hub with a hash table
+     network *n = newNetworkFromString("1-1,1-2,2-5,5-5,5-1,3-5,4-2", -1);
+     n->current = find(n, 5);
+     for(int i = 6; i < 40; i++) { addNode(n, i); n->current = find(n, 5); link(n, i, i); }
+     n->current = find(n, 39); link(n, 5, 1); link(n, 39, 1);
+     checkParents(n);
+     assert(deleteNode(n, 2));
+     checkParents(n);
+     assert(deleteNode(n, 1));
+     checkParents(n);
+     n->current = find(n, 5);
+     assert(edges(n) == 35 && getWeight(n, 5) == 1 && getWeight(n, 39) == 39);
+     assert(traverse(n, 39) && getWeight(n, 39) == 1 && getWeight(n, 5) == 1);
+     //Delete everything, taking from the middle each time
+     while(!empty(n)){
+          assert(deleteNode(n, n->inventory[n->size / 2]->x));
+          checkParents(n);
+     }
+     freeNetwork(n);
+}
+
+//Builds a network of v nodes with e random edges of weight 0 to 10
+network *randomNetwork(int v, int e){
+     network *n = newNetwork(-1);
+     for(int i = 0; i < v; i++) { addNode(n, i); }
+     for(int i = 0; i < e; i++){
+          n->current = n->inventory[rand() % v];
+          link(n, rand() % v, (rand() % 1000) / 100.0);
+     }
+     setRoot(n, 0);
+     return n;
+}
+
+void testDijkstraBatch(){
+     network *n = randomNetwork(300, 1500);
+     addNode(n, 1000);
+     int size = nodes(n);
+     //Roots include an isolated node, and an item that isn't in the network
+     item roots[] = {0, 5, 299, 1000, 77, 5000, 5};
+     int count = 7;
+     double *d = malloc(count * size * sizeof(double)), *expectedD = malloc(size * sizeof(double));
+     item *p = malloc(count * size * sizeof(item)), *expectedP = malloc(size * sizeof(item));
+     for(int threads = 0; threads <= 4; threads++){
+          dijkstraBatch(n, roots, count, d, p, threads);
+          for(int k = 0; k < count; k++){
+               //A missing root leaves every node unreachable
+               if(roots[k] == 5000){
+                    for(int i = 0; i < size; i++) { expectedD[i] = -1; expectedP[i] = n->null; }
+               }
+               else{
+                    setRoot(n, roots[k]);
+                    dijkstra(n, expectedD, expectedP);
+               }
+               assert(memcmp(d + k * size, expectedD, size * sizeof(double)) == 0);
+               assert(memcmp(p + k * size, expectedP, size * sizeof(item)) == 0);
+          }
+     }
+     //dijkstraFrom doesn't need the root to be set
+     setRoot(n, 0);
+     dijkstraFrom(n, 299, expectedD, expectedP);
+     assert(getRoot(n) == 0);
+     assert(memcmp(d + 2 * size, expectedD, size * sizeof(double)) == 0);
+     free(d); free(p); free(expectedD); free(expectedP);
+     freeNetwork(n);
+}
+
+//Checks d matches dijkstra from root, and that p gives a shortest path to every node
+void checkSteps(network *n, item root, double *d, item *p){
+     int size = nodes(n);
+     double *expected = malloc((size + 1) * sizeof(double));
+     item *expectedP = malloc((size + 1) * sizeof(item));
+     dijkstraFrom(n, root, expected, expectedP);
+     assert(memcmp(d, expected, size * sizeof(double)) == 0);
+     for(int i = 0; i < size; i++){
+          if(p[i] == n->null) { assert(expectedP[i] == n->null); continue; }
+          node *from = find(n, p[i]);
+          assert(d[getSlot(n, p[i])] + from->edge[findEdge(from, i)].weight == d[i]);
+     }
+     free(expected); free(expectedP);
+}
+
+void testDeltaStepping(){
+     network *n = randomNetwork(2000, 12000);
+     double *d = malloc(2000 * sizeof(double));
+     item *p = malloc(2000 * sizeof(item));
+     //Bucket widths from every edge being heavy to every edge being light
+     double deltas[] = {0, 0.01, 0.5, 3, 100};
+     for(int i = 0; i < 5; i++){
+          for(int threads = 1; threads <= 4; threads *= 2){
+               deltaStepping(n, 0, d, p, deltas[i], threads);
+               checkSteps(n, 0, d, p);
+               deltaStepping(n, 1234, d, p, deltas[i], threads);
+               checkSteps(n, 1234, d, p);
+          }
+     }
+     deltaStepping(n, 5000, d, p, 1, 2);
+     for(int i = 0; i < 2000; i++) { assert(d[i] == -1 && p[i] == -1); }
+     freeNetwork(n);
+
+     //Zero weights, self loops and a node that can't be reached
+     n = newNetworkFromString("1-2/0,2-3/0,3-1/0,1-1/4,3-4/2.5,5-1", -1);
+     deltaStepping(n, 1, d, p, 0, 2);
+     checkSteps(n, 1, d, p);
+     assert(d[getSlot(n, 4)] == 2.5 && d[getSlot(n, 5)] == -1);
+     freeNetwork(n);
+
+     //Widths far too narrow for the weights are widened rather than allocating billions of buckets
+     n = newNetworkFromString("1-2/1000,2-3/0.5,1-3/1000.25", -1);
+     double narrow[] = {1e-6, 1e-9, 1e-300, NAN};
+     for(int i = 0; i < 4; i++){
+          deltaStepping(n, 1, d, p, narrow[i], 2);
+          checkSteps(n, 1, d, p);
+          assert(d[getSlot(n, 3)] == 1000.25);
+     }
+     free(d); free(p);
+     freeNetwork(n);
+}
+
+void testShortestPath(){
+     network *n = randomNetwork(1500, 6000);
+     addNode(n, 2000);
+     int size = nodes(n);
+     double *d = malloc(size * sizeof(double));
+     item *p = malloc(size * sizeof(item)), *path = malloc(size * sizeof(item));
+     int len;
+     for(int root = 0; root < 20; root++){
+          dijkstraFrom(n, root, d, p);
+          for(int bidirectional = 0; bidirectional < 2; bidirectional++){
+               for(int i = 0; i < size; i++){
+                    item y = n->inventory[i]->x;
+                    double distance = bidirectional ? bidirectionalPath(n, root, y, path, &len)
+                                                    : shortestPath(n, root, y, path, &len);
+                    //The distance matches, and the path adds up to it along real edges
+                    //Adding the two halves of a bidirectional path can round differently
+                    assert((distance == -1) == (d[i] == -1));
+                    assert(distance - d[i] < 1e-9 && d[i] - distance < 1e-9);
+                    if(distance == -1) { assert(len == 0); continue; }
+                    assert(path[0] == root && path[len - 1] == y);
+                    double total = 0;
+                    for(int j = 0; j + 1 < len; j++){
+                         n->current = find(n, path[j]);
+                         assert(getWeight(n, path[j + 1]) != -1);
+                         total += getWeight(n, path[j + 1]);
+                    }
+                    assert(total - distance < 1e-9 && distance - total < 1e-9);
+               }
+          }
+     }
+     assert(shortestPath(n, 3, 3, path, &len) == 0 && len == 1 && path[0] == 3);
+     assert(bidirectionalPath(n, 3, 3, path, &len) == 0 && len == 1 && path[0] == 3);
+     assert(shortestPath(n, 3, 5000, path, &len) == -1 && len == 0);
+     assert(bidirectionalPath(n, 5000, 3, path, &len) == -1 && len == 0);
+
+     //Each search leaves the arrays it shares with the next one cleared, as the network grows and shrinks
+     for(int i = 3000; i < 3100; i++) { addNode(n, i); }
+     n->current = find(n, 3);
+     assert(link(n, 3099, 0.5));
+     assert(shortestPath(n, 3, 3099, path, &len) == 0.5 && len == 2 && path[1] == 3099);
+     assert(bidirectionalPath(n, 3, 3099, path, &len) == 0.5 && len == 2 && path[1] == 3099);
+     assert(deleteNode(n, 3099) && shortestPath(n, 3, 3098, path, &len) == -1 && len == 0);
+     searcher *s = n->search;
+     assert(s->capacity >= nodes(n) && s->touchedCount == 0 && heapEmpty(s->h[0]) && heapEmpty(s->h[1]));
+     for(int i = 0; i < s->capacity; i++){
+          assert(s->d[0][i] == -1 && s->d[1][i] == -1 && s->h[0]->pos[i] == -1 && s->h[1]->pos[i] == -1);
+     }
+     free(d); free(p); free(path);
+     freeNetwork(n);
+}
+
+//A width by width grid where item y * width + x has edges to the nodes above, below and either side
+//Every weight is at least 1, and about one node in ten is left out as an obstacle
+network *gridNetwork(int width){
+     network *n = newNetwork(-1);
+     for(int i = 0; i < width * width; i++){
+          if(i == 0 || rand() % 10 != 0) addNode(n, i);
+     }
+     int steps[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+     for(int i = 0; i < width * width; i++){
+          node *v = find(n, i);
+          if(v == NULL) continue;
+          for(int k = 0; k < 4; k++){
+               int x = i % width + steps[k][0], y = i / width + steps[k][1];
+               if(x < 0 || y < 0 || x >= width || y >= width) continue;
+               n->current = v;
+               link(n, y * width + x, 1 + (rand() % 400) / 100.0);
+          }
+     }
+     setRoot(n, 0);
+     return n;
+}
 
-     printf("\nAs an adjacency list: \n");
-     printList(n); printf("\n");
+//The number of steps between two grid items if there were no obstacles - never more than the real distance
+double gridSteps(item a, item b, void *ctx){
+     int width = *(int *)ctx;
+     return abs(a % width - b % width) + abs(a / width - b / width);
+}
 
-     printf("As an adjacency matrix: \n");
-     printMatrix(n); printf("\n");
+void testAstar(){
+     int width = 30;
+     network *n = gridNetwork(width);
+     int size = nodes(n);
+     item *path = malloc(size * sizeof(item)), *expected = malloc(size * sizeof(item));
+     int len, expectedLen;
+     for(int k = 0; k < 300; k++){
+          item src = n->inventory[rand() % size]->x, dst = n->inventory[rand() % size]->x;
+          double distance = shortestPath(n, src, dst, expected, &expectedLen);
+          for(int guided = 0; guided < 2; guided++){
+               double found = astar(n, src, dst, guided ? gridSteps : NULL, &width, path, &len);
+               //Sums of the same weights in a different order can round differently
+               assert(found - distance < 1e-9 && distance - found < 1e-9);
+               if(distance == -1) { assert(found == -1 && len == 0); continue; }
+               assert(path[0] == src && path[len - 1] == dst);
+               double total = 0;
+               for(int j = 0; j + 1 < len; j++){
+                    n->current = find(n, path[j]);
+                    assert(getWeight(n, path[j + 1]) != -1);
+                    total += getWeight(n, path[j + 1]);
+               }
+               assert(total - distance < 1e-9 && distance - total < 1e-9);
+          }
+     }
+     assert(astar(n, 0, 0, gridSteps, &width, path, &len) == 0 && len == 1 && path[0] == 0);
+     assert(astar(n, 0, -5, gridSteps, &width, path, &len) == -1 && len == 0);
+     free(path); free(expected);
+     freeNetwork(n);
+}
 
-     printf("Shortest path from root:\n");
-     double d[n->size];
-     item p[n->size];
-     dijkstra(n, d, p);
-     printDijkstra(n, d, p);
+//Checks that cachedDijkstra gives the same results as dijkstraFrom for root
+void checkCached(network *n, item root, double *d, item *p){
+     const double *cachedD;
+     const item *cachedP;
+     assert(cachedDijkstra(n, root, &cachedD, &cachedP));
+     dijkstraFrom(n, root, d, p);
+     for(int i = 0; i < nodes(n); i++) { assert(cachedD[i] == d[i] && cachedP[i] == p[i]); }
 }
 
-void testNewNetwork(){
-     network *n = newNetwork(-1);
-     assert(n->current == NULL);
-     assert(n->null == -1);
+void testCachedDijkstra(){
+     network *n = randomNetwork(400, 2000);
+     double *d = malloc(500 * sizeof(double));
+     item *p = malloc(500 * sizeof(item));
+     const double *first, *again;
+     const item *firstP, *againP;
+     //Asking again without a change gives back the same arrays
+     assert(cachedDijkstra(n, 7, &first, &firstP));
+     assert(cachedDijkstra(n, 7, &again, &againP));
+     assert(first == again && firstP == againP);
+     assert(!cachedDijkstra(n, 5000, &again, &againP) && again == NULL && againP == NULL);
+     //More roots than the cache holds, then every kind of change
+     for(int root = 0; root < 10; root++) { checkCached(n, root % 6, d, p); }
+     n->current = find(n, 7);
+     link(n, 399, 0.01);
+     checkCached(n, 7, d, p);
+     setWeight(n, 399, 5);
+     checkCached(n, 7, d, p);
+     unlink(n, 399);
+     checkCached(n, 7, d, p);
+     addNode(n, 450);
+     link(n, 7, 0);
+     n->current = find(n, 7);
+     link(n, 450, 0);
+     checkCached(n, 7, d, p);
+     n->current = find(n, 450);
+     set(n, 460);
+     checkCached(n, 7, d, p);
+     deleteNode(n, 460);
+     checkCached(n, 7, d, p);
+     deleteNode(n, 0);
+     checkCached(n, 7, d, p);
+     //dijkstra reads the cache too
+     setRoot(n, 7);
+     double *rootD = malloc(500 * sizeof(double));
+     item *rootP = malloc(500 * sizeof(item));
+     dijkstra(n, rootD, rootP);
+     for(int i = 0; i < nodes(n); i++) { assert(rootD[i] == d[i] && rootP[i] == p[i]); }
+     //Sorting moves the nodes to other slots
+     sortInventory(n);
+     checkCached(n, 7, d, p);
+     free(d); free(p); free(rootD); free(rootP);
      freeNetwork(n);
 }
 
-void testAddNode(){
-     network *n = newNetwork(-1);
-     //Add to empty list
-     assert(addNode(n, 5));
-     assert(n->current->x == 5);
-     //Add to non-empty list
-     assert(addNode(n, 4));
-     assert(n->current->x == 4);
-     //Add invalid value
-     assert(addNode(n, 4) == false);
-     //Add null value
-     assert(addNode(n, -1) == false);
+//Checks that the paths kept for n match a fresh run of dijkstraFrom from root
+//Equally short paths may be chosen differently, so each previous node is checked to give the distance
+void checkTracked(network *n, item root, double *d, item *p){
+     const double *trackedD;
+     const item *trackedP;
+     assert(trackedPaths(n, &trackedD, &trackedP));
+     dijkstraFrom(n, root, d, p);
+     for(int i = 0; i < nodes(n); i++){
+          assert(trackedD[i] - d[i] < 1e-9 && d[i] - trackedD[i] < 1e-9);
+          if(d[i] == -1 || n->inventory[i]->x == root) { assert(trackedP[i] == n->null); continue; }
+          n->current = find(n, trackedP[i]);
+          double w = getWeight(n, n->inventory[i]->x);
+          assert(w != -1);
+          assert(trackedD[getSlot(n, trackedP[i])] + w == trackedD[i]);
+     }
+}
 
+void testTrackShortestPaths(){
+     network *n = randomNetwork(300, 1200);
+     double *d = malloc(2000 * sizeof(double));
+     item *p = malloc(2000 * sizeof(item));
+     const double *trackedD;
+     const item *trackedP;
+     assert(!trackedPaths(n, &trackedD, &trackedP) && trackedD == NULL);
+     assert(!trackShortestPaths(n, 5000));
+     assert(trackShortestPaths(n, 0));
+     checkTracked(n, 0, d, p);
+     item next = 1000;
+     for(int k = 0; k < 3000; k++){
+          node *v = n->inventory[rand() % nodes(n)];
+          item y = n->inventory[rand() % nodes(n)]->x;
+          n->current = v;
+          int op = rand() % 10;
+          if(op < 3) link(n, y, (rand() % 1000) / 100.0);
+          else if(op < 5 && v->links > 0) unlink(n, n->inventory[v->edge[rand() % v->links].target]->x);
+          else if(op < 8 && v->links > 0){
+               item target = n->inventory[v->edge[rand() % v->links].target]->x;
+               setWeight(n, target, (rand() % 1000) / 100.0);
+          }
+          else if(op == 8) addNode(n, next++);
+          else if(v->x != 0){
+               if(rand() % 2) deleteNode(n, v->x);
+               else set(n, next++);
+          }
+          checkTracked(n, 0, d, p);
+     }
+     sortInventory(n);
+     checkTracked(n, 0, d, p);
+     //Deleting the root leaves nothing reachable
+     deleteNode(n, 0);
+     assert(trackedPaths(n, &trackedD, &trackedP));
+     for(int i = 0; i < nodes(n); i++) { assert(trackedD[i] == -1 && trackedP[i] == n->null); }
+     stopTracking(n);
+     assert(!trackedPaths(n, &trackedD, &trackedP));
+     free(d); free(p);
      freeNetwork(n);
 }
 
-void testDeleteNode(){
-     network *n = newNetworkFromString("1-2,2-3,3-1", -1);
-     assert(get(n) == 1 && getRoot(n) == 1);
-     //Doesn't delete nodes not in n
-     assert(!deleteNode(n, 4));
-     //Does delete nodes inside n
-     assert(deleteNode(n, 1));
-     //New node is the first one in inventory (n->inventory[0])
-     //Root has been deleted, so getRoot returns null
-     assert(get(n) == 2 && getRoot(n) == -1);
-     //Make sure edges to 1 are deleted
-     assert(find(n, 3)->links == 0);
-     //Make sure size is updated
-     assert(nodes(n) == 2);
-     //Make sure network can be emptied
-     assert(deleteNode(n, 2));
-     assert(deleteNode(n, 3));
-     assert(empty(n));
-
+void testAllPairsShortest(){
+     network *n = randomNetwork(150, 900);
+     addNode(n, 500);
+     int size = nodes(n);
+     double *dist = malloc(size * size * sizeof(double)), *d = malloc(size * sizeof(double));
+     item *next = malloc(size * size * sizeof(item)), *p = malloc(size * sizeof(item));
+     for(int threads = 1; threads <= 4; threads += 3){
+          allPairsShortest(n, dist, next, threads);
+          for(int i = 0; i < size; i++){
+               item x = n->inventory[i]->x;
+               dijkstraFrom(n, x, d, p);
+               for(int j = 0; j < size; j++){
+                    double found = dist[i * size + j];
+                    //Paths are added up in a different order, so can round differently
+                    assert((found == -1) == (d[j] == -1));
+                    assert(found - d[j] < 1e-9 && d[j] - found < 1e-9);
+                    item y = n->inventory[j]->x;
+                    if(found == -1) { assert(next[i * size + j] == n->null); continue; }
+                    //Following next from x reaches y along edges adding up to the distance
+                    double total = 0;
+                    item at = x;
+                    while(at != y){
+                         item hop = next[getSlot(n, at) * size + j];
+                         n->current = find(n, at);
+                         assert(getWeight(n, hop) != -1);
+                         total += getWeight(n, hop);
+                         at = hop;
+                    }
+                    assert(total - found < 1e-9 && found - total < 1e-9);
+               }
+          }
+     }
+     //The paths aren't needed
+     allPairsShortest(n, dist, NULL, 2);
+     free(dist); free(d); free(next); free(p);
+     freeNetwork(n);
+     n = newNetwork(-1);
+     allPairsShortest(n, NULL, NULL, 2);
      freeNetwork(n);
 }
 
@@ -922,6 +3846,85 @@ void testFind(){
      freeNetwork(n);
 }
 
+void testIndex(){
+     network *n = newNetwork(-1);
+     //Enough nodes to make the hash table grow several times
+     for(int i = 0; i < 1000; i++) { addNode(n, i * 7); }
+     for(int i = 0; i < 1000; i++) { assert(getSlot(n, i * 7) == i); }
+     assert(getSlot(n, 3) == -1);
+     //The last node moves into a deleted node's slot
+     assert(deleteNode(n, 0));
+     assert(getSlot(n, 0) == -1 && getSlot(n, 6993) == 0 && getSlot(n, 21) == 3);
+     //Renaming a node moves its entry in the table
+     n->current = find(n, 14);
+     assert(set(n, 5));
+     assert(getSlot(n, 5) == 2 && getSlot(n, 14) == -1);
+     //Renaming every node checks removal keeps each run of buckets reachable
+     for(int i = 0; i < nodes(n); i++){
+          n->current = n->inventory[i];
+          assert(set(n, 100000 + i));
+     }
+     for(int i = 0; i < nodes(n); i++) { assert(getSlot(n, 100000 + i) == i); }
+     freeNetwork(n);
+}
+
+void testSortInventory(){
+     network *n = newNetworkFromString("3-1/2,1-2/5,2-3/4", -1);
+     //Sorted when created, with each edge moved to its target's new slot
+     for(int i = 0; i < 3; i++) { assert(n->inventory[i]->x == i + 1); }
+     assert(get(n) == 3 && getWeight(n, 1) == 2);
+     assert(traverse(n, 1) && getWeight(n, 2) == 5);
+     assert(traverse(n, 2) && getWeight(n, 3) == 4);
+     freeNetwork(n);
+
+     //Large networks in reverse order, with a chain of edges to check after the sort
+     int size = 50000;
+     n = newNetwork(-1);
+     for(int i = size; i >= 1; i--){
+          addNode(n, i);
+          if(i < size) { n->current = find(n, i); link(n, i + 1, i); }
+     }
+     sortInventory(n);
+     for(int i = 0; i < size; i++) { assert(n->inventory[i]->x == i + 1 && getSlot(n, i + 1) == i); }
+     n->current = find(n, 1);
+     for(int i = 1; i < size; i++) { assert(getWeight(n, i + 1) == i && traverse(n, i + 1)); }
+     assert(n->inventory[size - 1]->parentCount == 1);
+     freeNetwork(n);
+}
+
+void testHubEdges(){
+     network *n = newNetwork(-1);
+     int hub = 5000;
+     for(int i = 0; i <= hub; i++) { addNode(n, i); }
+     n->current = find(n, 0);
+     //Building a hub checks every new edge against all of the existing ones
+     for(int i = hub; i >= 1; i--) { assert(link(n, i, i)); }
+     assert(n->current->lookup != NULL && edges(n) == hub);
+     assert(link(n, 7, 1) == false);
+     for(int i = 1; i <= hub; i++) { assert(getWeight(n, i) == i); }
+     assert(setWeight(n, 10, 0.5) && getWeight(n, 10) == 0.5);
+     assert(getWeight(n, 0) == -1);
+
+     //Edges keep the order they were added in
+     assert(n->inventory[n->current->edge[0].target]->x == hub);
+     assert(unlink(n, hub) && getWeight(n, hub) == -1 && getWeight(n, hub - 1) == hub - 1);
+     assert(n->inventory[n->current->edge[0].target]->x == hub - 1);
+     checkParents(n);
+
+     //Deleting nodes moves targets down, which the table has to follow
+     for(int i = 1; i <= hub - 20; i++) { assert(deleteNode(n, i)); }
+     checkParents(n);
+     n->current = find(n, 0);
+     assert(edges(n) == 19 && n->current->lookup != NULL);
+     for(int i = hub - 19; i < hub; i++){
+          assert(getWeight(n, i) == i && traverse(n, i));
+          n->current = find(n, 0);
+     }
+     for(int i = hub - 19; i < hub - 10; i++) { assert(unlink(n, i)); }
+     assert(edges(n) == 10 && n->current->lookup == NULL && getWeight(n, hub - 1) == hub - 1);
+     freeNetwork(n);
+}
+
 void testLink(){
      network *n = newNetwork(-1);
      addNode(n, 3);
@@ -929,7 +3932,7 @@ void testLink(){
      assert(n->current->links == 0);
      assert(link(n, 3, 2.5));
      assert(n->current->links == 1);
-     assert(n->current->weight[0] == 2.5);
+     assert(n->current->edge[0].weight == 2.5);
      freeNetwork(n);
 }
 
@@ -1001,6 +4004,21 @@ void testTree(){
      n = newNetworkFromString("1-2,1-4,5-1", -1);
      assert(isTree(n) == false);
      freeNetwork(n);
+
+     //Every node but the root has one parent, but 3 and 4 form a cycle cut off from 1
+     n = newNetworkFromString("1-2,3-4,4-3", -1);
+     assert(isTree(n) == false);
+     freeNetwork(n);
+
+     //A wide tree with many levels
+     n = newNetwork(-1);
+     for(int i = 1; i <= 100000; i++){
+          addNode(n, i);
+          if(i > 1) { n->current = n->inventory[i / 2 - 1]; link(n, i, 1); }
+     }
+     assert(isTree(n));
+     assert(depth(n) == 17);
+     freeNetwork(n);
 }
 
 void testDepth(){
@@ -1024,6 +4042,162 @@ void testDepth(){
      freeNetwork(n);
 }
 
+void testDeepNetworks(){
+     //A chain far longer than the C stack could hold as recursion
+     network *n = newNetwork(-1);
+     int len = 200000;
+     for(int i = 0; i < len; i++){
+          addNode(n, i);
+          if(i > 0) { n->current = n->inventory[i - 1]; link(n, i, 1); }
+     }
+     reset(n);
+     assert(isCyclic(n) == false);
+     assert(depth(n) == len);
+     assert(depthFirstSearch(n, len - 1, true) && get(n) == len - 1);
+     assert(breadthFirstSearch(n, len - 1, false));
+     n->current = n->inventory[len - 1]; link(n, 0, 1);
+     reset(n);
+     assert(isCyclic(n));
+     freeNetwork(n);
+
+     //Sixty diamonds in a row share every node below them - 2^60 paths in total
+     n = newNetwork(-1);
+     addNode(n, 0);
+     for(int i = 0; i < 60; i++){
+          int top = 3 * i;
+          addNode(n, top + 1); addNode(n, top + 2); addNode(n, top + 3);
+          n->current = find(n, top); link(n, top + 1, 1); link(n, top + 2, 1);
+          n->current = find(n, top + 1); link(n, top + 3, 1);
+          n->current = find(n, top + 2); link(n, top + 3, 1);
+     }
+     reset(n);
+     assert(isCyclic(n) == false);
+     assert(depth(n) == -1);
+     assert(depthFirstSearch(n, 180, false));
+     freeNetwork(n);
+}
+
+void testStrongComponents(){
+     network *n = newNetworkFromString("1-2,2-3,3-1,3-4/2,2-4/5,4-5,5-4,6,7-7,6-1/3", -1);
+     int size = nodes(n);
+     int component[size];
+     assert(strongComponents(n, component) == 4);
+     //Nodes are sorted, so slot i holds item i + 1
+     assert(component[0] == component[1] && component[1] == component[2]);
+     assert(component[3] == component[4] && component[3] != component[0]);
+     assert(component[5] != component[0] && component[6] != component[0] && component[5] != component[6]);
+     assert(component[5] < component[0] && component[0] < component[3]);
+
+     network *c = condense(n);
+     assert(nodes(c) == 4);
+     assert(getRoot(c) == component[0]);
+     //The lighter of the two edges from {1,2,3} to {4,5} is kept, and loops are dropped
+     c->current = find(c, component[0]);
+     assert(edges(c) == 1 && getWeight(c, component[3]) == 2);
+     c->current = find(c, component[5]);
+     assert(edges(c) == 1 && getWeight(c, component[0]) == 3);
+     c->current = find(c, component[6]);
+     assert(edges(c) == 0);
+     freeNetwork(c);
+     freeNetwork(n);
+
+     //Two nodes share a component exactly when each can reach the other
+     n = randomNetwork(200, 300);
+     size = nodes(n);
+     int ids[size];
+     int count = strongComponents(n, ids);
+     double *d = malloc(size * size * sizeof(double));
+     item *p = malloc(size * size * sizeof(item));
+     allPairsShortest(n, d, p, 1);
+     for(int i = 0; i < size; i++){
+          for(int j = 0; j < size; j++){
+               bool both = d[i * size + j] != -1 && d[j * size + i] != -1;
+               assert(both == (ids[i] == ids[j]));
+          }
+     }
+     c = condense(n);
+     assert(nodes(c) == count);
+     for(int i = 0; i < count; i++){
+          node *v = c->inventory[i];
+          for(int k = 0; k < v->links; k++) { assert(v->x < c->inventory[v->edge[k].target]->x); }
+     }
+     c->current = c->inventory[0];
+     assert(!isCyclic(c));
+     free(d); free(p);
+     freeNetwork(c);
+     freeNetwork(n);
+
+     //One cycle far longer than the C stack could hold as recursion
+     int len = 200000;
+     item *src = malloc(len * sizeof(item)), *dst = malloc(len * sizeof(item));
+     for(int i = 0; i < len; i++) { src[i] = i; dst[i] = (i + 1) % len; }
+     n = newNetworkFromEdges(src, dst, NULL, len, -1);
+     int *big = malloc(len * sizeof(int));
+     assert(strongComponents(n, big) == 1);
+     c = condense(n);
+     assert(nodes(c) == 1 && getRoot(c) == 0 && edges(c) == 0);
+     free(src); free(dst); free(big);
+     freeNetwork(c);
+     freeNetwork(n);
+}
+
+void testTopologicalOrder(){
+     network *n = newNetworkFromString("1-2,1-3,2-4,3-4,4-5,6-5,7", -1);
+     item out[7];
+     int levelStart[8];
+     assert(topologicalOrder(n, out) == 7);
+     assert(topologicalLevels(n, out, levelStart) == 4);
+     //{1,6,7}, then {2,3}, then {4}, then {5}
+     int expectedStart[] = {0, 3, 5, 6, 7};
+     for(int i = 0; i < 5; i++) { assert(levelStart[i] == expectedStart[i]); }
+     assert(out[5] == 4 && out[6] == 5);
+     n->current = find(n, 5);
+     link(n, 1, 1);
+     assert(topologicalOrder(n, out) == -1);
+     assert(topologicalLevels(n, out, levelStart) == -1);
+     freeNetwork(n);
+
+     n = newNetwork(-1);
+     assert(topologicalOrder(n, out) == 0);
+     assert(topologicalLevels(n, out, levelStart) == 0 && levelStart[0] == 0);
+     freeNetwork(n);
+
+     //Random edges that only go to higher items, so there are no cycles
+     int v = 2000, e = 10000;
+     item *src = malloc(e * sizeof(item)), *dst = malloc(e * sizeof(item));
+     for(int i = 0; i < e; i++){
+          src[i] = rand() % (v - 1);
+          dst[i] = src[i] + 1 + rand() % (v - 1 - src[i]);
+     }
+     n = newNetworkFromEdges(src, dst, NULL, e, -1);
+     int size = nodes(n);
+     item *order = malloc(size * sizeof(item));
+     int *starts = malloc((size + 1) * sizeof(int));
+     int *position = malloc(v * sizeof(int)), *level = malloc(v * sizeof(int));
+     assert(topologicalOrder(n, order) == size);
+     for(int i = 0; i < size; i++) { position[order[i]] = i; }
+     for(int i = 0; i < e; i++) { assert(position[src[i]] < position[dst[i]]); }
+     int levels = topologicalLevels(n, order, starts);
+     assert(levels > 0 && starts[0] == 0 && starts[levels] == size);
+     for(int k = 0; k < levels; k++){
+          assert(starts[k] < starts[k + 1]);
+          for(int i = starts[k]; i < starts[k + 1]; i++) { level[order[i]] = k; }
+     }
+     //Each node is one level below its deepest parent
+     for(int i = 0; i < e; i++) { assert(level[src[i]] < level[dst[i]]); }
+     for(int i = 0; i < size; i++){
+          node *m = n->inventory[i];
+          int deepest = -1;
+          for(int j = 0; j < m->parentCount; j++){
+               int l = level[n->inventory[m->parents[j]]->x];
+               if(l > deepest) deepest = l;
+          }
+          assert(level[m->x] == deepest + 1);
+     }
+     free(src); free(dst); free(order); free(starts); free(position); free(level);
+     freeNetwork(n);
+}
+
 void testDepthFirstSearch(){
      network *n = newNetwork(-1);
 
@@ -1073,6 +4247,18 @@ void testBreadthFirstSearch(){
      freeNetwork(n);
 }
 
+void testBreadthFirstOrder(){
+     network *n = newNetworkFromString("1-3,1-2,2-4,3-4,4-5,6", -1);
+     item out[6];
+     assert(breadthFirstOrder(n, out) == 5);
+     assert(out[0] == 1 && out[1] == 3 && out[2] == 2 && out[3] == 4 && out[4] == 5);
+     freeNetwork(n);
+
+     n = newNetwork(-1);
+     assert(breadthFirstOrder(n, out) == 0);
+     freeNetwork(n);
+}
+
 void testIsSubNet(){
      network *n = newNetwork(-1); addNode(n, 3);
      network *m = newNetwork(-1);
@@ -1104,6 +4290,130 @@ void testIsSubNet(){
 
      freeNetwork(n);
      freeNetwork(m);
+
+     //Every edge of m is taken from n, including ones from hub nodes with hashed edges
+     n = randomNetwork(3000, 30000);
+     addNode(n, 5000);
+     for(int i = 0; i < 100; i++) { link(n, i, 1); }
+     m = newNetwork(-1);
+     for(int i = 0; i < 2000; i++){
+          node *v = n->inventory[rand() % nodes(n)];
+          if(v->links == 0) continue;
+          item y = n->inventory[v->edge[rand() % v->links].target]->x;
+          addNode(m, v->x);
+          addNode(m, y);
+          m->current = find(m, v->x);
+          link(m, y, 1);
+     }
+     assert(isSubNet(n, m));
+     assert(isSubNet(n, n));
+     //An edge n doesn't have, on the last node checked
+     node *last = m->inventory[m->size - 1];
+     n->current = find(n, last->x);
+     item missing = 0;
+     while(missing == last->x || getWeight(n, missing) != -1) { missing++; }
+     addNode(m, missing);
+     m->current = last;
+     link(m, missing, 1);
+     assert(!isSubNet(n, m));
+     //A node n doesn't have
+     unlink(m, missing);
+     assert(isSubNet(n, m));
+     addNode(m, 9999);
+     assert(!isSubNet(n, m));
+     //m has more nodes than n
+     assert(!isSubNet(m, n));
+     freeNetwork(n);
+     freeNetwork(m);
+}
+
+//Counts the matches findSubNets gives, and checks each one against the edges of the pattern
+typedef struct matchCheck{
+     network *host;
+     network *pattern;
+     int count;
+     //Stop after this many, or never if 0
+     int stopAt;
+} matchCheck;
+
+bool checkMatch(const item *match, void *ctx){
+     matchCheck *c = ctx;
+     int size = nodes(c->pattern);
+     for(int i = 0; i < size; i++){
+          for(int j = 0; j < size; j++){
+               if(i != j) assert(match[i] != match[j]);
+               c->pattern->current = c->pattern->inventory[i];
+               if(getWeight(c->pattern, c->pattern->inventory[j]->x) == -1) continue;
+               c->host->current = find(c->host, match[i]);
+               assert(getWeight(c->host, match[j]) != -1);
+          }
+     }
+     c->count++;
+     return c->stopAt == 0 || c->count < c->stopAt;
+}
+
+//Counts the ways of matching pattern nodes from slot k on to unused host nodes by trying every one
+int bruteMatches(network *host, network *pattern, int k, int *map, bool *used){
+     int size = nodes(pattern);
+     if(k == size) return 1;
+     int total = 0;
+     for(int h = 0; h < nodes(host); h++){
+          if(used[h]) continue;
+          map[k] = h;
+          bool fits = true;
+          for(int i = 0; i <= k && fits; i++){
+               for(int j = 0; j <= k && fits; j++){
+                    pattern->current = pattern->inventory[i];
+                    if(getWeight(pattern, pattern->inventory[j]->x) == -1) continue;
+                    host->current = host->inventory[map[i]];
+                    if(getWeight(host, host->inventory[map[j]]->x) == -1) fits = false;
+               }
+          }
+          if(!fits) continue;
+          used[h] = true;
+          total += bruteMatches(host, pattern, k + 1, map, used);
+          used[h] = false;
+     }
+     return total;
+}
+
+void testFindSubNets(){
+     //A 3-cycle with other labels occurs three times in 1-2-3-1, once for each starting point
+     network *host = newNetworkFromString("1-2,2-3,3-1,3-4,4-1", -1);
+     network *pattern = newNetworkFromString("7-8,8-9,9-7", -1);
+     matchCheck c = {.host = host, .pattern = pattern, .count = 0, .stopAt = 0};
+     assert(findSubNets(host, pattern, 0, checkMatch, &c) == 3 && c.count == 3);
+     //A limit, and a callback that stops the search
+     assert(findSubNets(host, pattern, 2, NULL, NULL) == 2);
+     c.count = 0; c.stopAt = 1;
+     assert(findSubNets(host, pattern, 0, checkMatch, &c) == 1 && c.count == 1);
+     //Loops have to match loops
+     freeNetwork(pattern);
+     pattern = newNetworkFromString("5-5", -1);
+     assert(findSubNets(host, pattern, 0, NULL, NULL) == 0);
+     host->current = find(host, 4); link(host, 4, 1);
+     assert(findSubNets(host, pattern, 0, NULL, NULL) == 1);
+     //Patterns larger than the host, and empty ones, never match
+     assert(findSubNets(pattern, host, 0, NULL, NULL) == 0);
+     freeNetwork(pattern);
+     pattern = newNetwork(-1);
+     assert(findSubNets(host, pattern, 0, NULL, NULL) == 0);
+     freeNetwork(pattern);
+     freeNetwork(host);
+
+     //Random hosts and patterns, checked against trying every assignment
+     for(int round = 0; round < 20; round++){
+          host = randomNetwork(9, 30);
+          pattern = randomNetwork(2 + round % 3, 2 + round % 5);
+          int size = nodes(pattern);
+          int map[size];
+          bool used[9] = {false};
+          int expected = bruteMatches(host, pattern, 0, map, used);
+          c = (matchCheck){.host = host, .pattern = pattern, .count = 0, .stopAt = 0};
+          assert(findSubNets(host, pattern, 0, checkMatch, &c) == expected && c.count == expected);
+          freeNetwork(pattern);
+          freeNetwork(host);
+     }
 }
 
 void testDijkstra(){
@@ -1114,7 +4424,20 @@ void testDijkstra(){
 
      assert(d[0] == 0 && d[1] == 1 && d[2] == 4 && d[3] == 5.5 && d[4] == -1);
      assert(p[0] == -1 && p[1] == 1 && p[2] == 1 && p[3] == 3 && p[4] == -1);
+     freeNetwork(n);
+
+     //2 is first reached directly, then through the cheaper path via 3
+     n = newNetworkFromString("1-2/10,1-3/1,3-2/1,2-4/1,4-1/1", -1);
+     dijkstra(n, d, p);
+     assert(d[0] == 0 && d[1] == 2 && d[2] == 1 && d[3] == 3);
+     assert(p[0] == -1 && p[1] == 3 && p[2] == 1 && p[3] == 2);
+     freeNetwork(n);
 
+     //A network without a root has nothing reachable
+     n = newNetworkFromString("1-2", -1);
+     deleteNode(n, 1);
+     dijkstra(n, d, p);
+     assert(d[0] == -1 && p[0] == -1);
      freeNetwork(n);
 }
 
@@ -1158,6 +4481,99 @@ void testGetPath(){
      freeNetwork(n);
 }
 
+void testFreezeNetwork(){
+     network *n = newNetworkFromString("1-2,1-3/4,2-3/5,3-4/1.5,5", -1);
+     frozen *f = freezeNetwork(n);
+     assert(frozenNodes(f) == 5);
+     assert(frozenItem(f, 0) == 1 && frozenItem(f, 4) == 5 && frozenItem(f, 5) == -1);
+     assert(f->edges == 4 && f->offsets[1] == 2 && f->targets[0] == 1 && f->weights[1] == 4);
+
+     //Same results as running on the network itself
+     double d[5], fd[5];
+     item p[5], fp[5];
+     dijkstra(n, d, p);
+     frozenDijkstra(f, fd, fp);
+     for(int i = 0; i < 5; i++) { assert(d[i] == fd[i] && p[i] == fp[i]); }
+     assert(getShortestDistance(n, 4, fd) == 5.5);
+
+     assert(frozenDepthFirstSearch(f, 4) && frozenBreadthFirstSearch(f, 4));
+     assert(!frozenDepthFirstSearch(f, 5) && !frozenBreadthFirstSearch(f, 5));
+     assert(!frozenDepthFirstSearch(f, 6) && !frozenBreadthFirstSearch(f, 6));
+
+     network *m = newNetworkFromString("2-3,3-4", -1);
+     assert(frozenIsSubNet(f, m));
+     freeNetwork(m);
+     m = newNetworkFromString("3-2", -1);
+     assert(frozenIsSubNet(f, m) == false);
+     freeNetwork(m);
+
+     //Changing the network leaves the snapshot alone
+     deleteNode(n, 3);
+     assert(frozenBreadthFirstSearch(f, 4));
+     assert(!breadthFirstSearch(n, 4, false));
+
+     freeFrozen(f);
+     freeNetwork(n);
+}
+
+void testSaveNetwork(){
+     char *path = "network_test.bin";
+     network *n = newNetworkFromString("1-2,1-3/4,2-3/5,3-4/1.5,5", -1);
+     assert(saveNetwork(n, path));
+
+     frozen *f = loadNetwork(path);
+     assert(f != NULL && frozenNodes(f) == 5 && f->edges == 4);
+     for(int i = 0; i < 5; i++) { assert(frozenItem(f, i) == n->inventory[i]->x); }
+     double d[5], fd[5];
+     item p[5], fp[5];
+     dijkstra(n, d, p);
+     frozenDijkstra(f, fd, fp);
+     for(int i = 0; i < 5; i++) { assert(d[i] == fd[i] && p[i] == fp[i]); }
+     assert(frozenBreadthFirstSearch(f, 4) && !frozenDepthFirstSearch(f, 5));
+     assert(frozenIsSubNet(f, n));
+     freeFrozen(f);
+
+     //Files of the right length whose arrays are wrong are rejected
+     size_t length;
+     char *mapping = mapFile(path, &length);
+     char *bytes = malloc(length);
+     memcpy(bytes, mapping, length);
+     unmapFile(mapping, length);
+     fileHeader h;
+     memcpy(&h, bytes, sizeof(h));
+     size_t sections[5];
+     assert(fileLayout(&h, sections) == length);
+     int *offsets = (int*)(bytes + sections[2]);
+     for(int k = 0; k < 5; k++){
+          char *copy = malloc(length);
+          memcpy(copy, bytes, length);
+          int *targets = (int*)(copy + sections[3]), *buckets = (int*)(copy + sections[4]);
+          //A target that isn't a node, offsets that go down, buckets with no gap or out of range,
+          //and a negative weight
+          if(k == 0) targets[0] = 1000000;
+          else if(k == 1) ((int*)(copy + sections[2]))[1] = offsets[2] + 1;
+          else if(k == 2) { for(int b = 0; b < h.bucketCount; b++) { buckets[b] = 0; } }
+          else if(k == 3) buckets[0] = -2;
+          else *(double*)(copy + sections[0]) = -1;
+          FILE *file = fopen(path, "wb");
+          fwrite(copy, 1, length, file);
+          fclose(file);
+          assert(loadNetwork(path) == NULL);
+          free(copy);
+     }
+     free(bytes);
+
+     //A file that has been cut short is rejected
+     FILE *file = fopen(path, "wb");
+     fwrite("NETW", 1, 4, file);
+     fclose(file);
+     assert(loadNetwork(path) == NULL);
+
+     remove(path);
+     assert(loadNetwork(path) == NULL);
+     freeNetwork(n);
+}
+
 void testCheckTerm(){
      assert(checkTerm("1-2"));
      assert(checkTerm("1"));
@@ -1170,6 +4586,53 @@ void testCheckTerm(){
      assert(checkTerm("1-") == false);
      assert(checkTerm("1-2/") == false);
      assert(checkTerm("1/3") == false);
+     assert(checkTerm("1-2/3.4.5") == false);
+     assert(checkTerm("1-2,3") == false);
+}
+
+void testNewNetworkFromBuffer(){
+     //Only the first length characters are read, and line breaks separate terms too
+     char *s = "1-2,1-3/4\n2-3/5\r\n3-4/1.5,,5,9-9";
+     network *n = newNetworkFromBuffer(s, strlen(s) - 4, -1);
+     assert(nodes(n) == 5 && get(n) == 1 && getRoot(n) == 1);
+     assert(getWeight(n, 3) == 4);
+     traverse(n, 3);
+     assert(getWeight(n, 4) == 1.5);
+     freeNetwork(n);
+
+     assert(newNetworkFromBuffer(s, 0, -1) == NULL);
+
+     //Invalid text is tried through parseNetwork, which leaves printing the error to the public functions
+     parser ps;
+     bool valid;
+     newParser(&ps, "1-2,1-2/", 8, NULL);
+     assert(parseNetwork(&ps, -1, &valid) == NULL && !valid && strcmp(ps.term, "1-2/") == 0);
+}
+
+void testNewNetworkFromFile(){
+     //Long enough that terms are split across the chunks the file is read in
+     FILE *f = tmpfile();
+     for(int i = 1; i < 3000; i++) { fprintf(f, "%d-%d/%d.5,", i, i + 1, i % 10); }
+     fprintf(f, "3001\n");
+     rewind(f);
+     network *n = newNetworkFromFile(f, -1);
+     assert(nodes(n) == 3001 && getRoot(n) == 1);
+     for(int i = 1; i < 3000; i++){
+          assert(get(n) == i);
+          assert(getWeight(n, i + 1) == i % 10 + 0.5);
+          traverse(n, i + 1);
+     }
+     freeNetwork(n);
+
+     //An invalid term part way through gives no network
+     rewind(f);
+     fprintf(f, "1-2,1-x");
+     rewind(f);
+     parser ps;
+     bool valid;
+     newParser(&ps, NULL, 0, f);
+     assert(parseNetwork(&ps, -1, &valid) == NULL && !valid && strcmp(ps.term, "1-x") == 0);
+     fclose(f);
 }
 
 void testAddTerm(){
@@ -1183,15 +4646,15 @@ void testAddTerm(){
      addTerm(n, "1-2");
      assert(n->current->x == 1);
      assert(n->current->links == 1);
-     assert(n->current->edge[0]->x == 2);
+     assert(n->inventory[n->current->edge[0].target]->x == 2);
      freeNetwork(n);
 
      n = newNetwork(-1);
      addTerm(n, "1-2/3");
      assert(n->current->x == 1);
      assert(n->current->links == 1);
-     assert(n->current->edge[0]->x == 2);
-     assert(n->current->weight[0] == 3);
+     assert(n->inventory[n->current->edge[0].target]->x == 2);
+     assert(n->current->edge[0].weight == 3);
      freeNetwork(n);
 
      n = newNetwork(1);
@@ -1204,12 +4667,25 @@ void test(){
      testNewNetwork();
      testAddNode();
      testDeleteNode();
+     testNewNetworkFromEdges();
+     testNewNetworkArena();
+     testDeleteNodeParents();
+     testDijkstraBatch();
+     testDeltaStepping();
+     testShortestPath();
+     testAstar();
+     testCachedDijkstra();
+     testTrackShortestPaths();
+     testAllPairsShortest();
      testEmpty();
      testGet();
      testSet();
      testNodes();
      testTraverse();
      testFind();
+     testIndex();
+     testHubEdges();
+     testSortInventory();
      testLink();
      testUnlink();
      testGetWeight();
@@ -1217,20 +4693,359 @@ void test(){
      testCyclic();
      testTree();
      testDepth();
+     testDeepNetworks();
+     testStrongComponents();
+     testTopologicalOrder();
      testDepthFirstSearch();
      testBreadthFirstSearch();
+     testBreadthFirstOrder();
      testIsSubNet();
+     testFindSubNets();
      testDijkstra();
      testGetDistance();
      testGetPath();
+     testFreezeNetwork();
+     testSaveNetwork();
      testCheckTerm();
      testAddTerm();
+     testNewNetworkFromBuffer();
+     testNewNetworkFromFile();
 
      printf("Network module tests run OK.\n");
 }
 
+void benchDijkstra(){
+     int sizes[] = {100000, 300000, 1000000};
+     for(int i = 0; i < 3; i++){
+          int e = sizes[i], v = e / 10;
+          network *n = randomNetwork(v, e);
+          double *d = malloc(v * sizeof(double));
+          item *p = malloc(v * sizeof(item));
+
+          clock_t start = clock();
+          dijkstra(n, d, p);
+          double t = (double)(clock() - start) / CLOCKS_PER_SEC;
+          printf("dijkstra: %7d nodes, %8d edges: %8.2f ms\n", v, e, t * 1000);
+
+          frozen *f = freezeNetwork(n);
+          start = clock();
+          frozenDijkstra(f, d, p);
+          t = (double)(clock() - start) / CLOCKS_PER_SEC;
+          printf("frozenDijkstra: %17s %8.2f ms\n", "", t * 1000);
+          freeFrozen(f);
+
+          free(d); free(p);
+          freeNetwork(n);
+     }
+}
+
+//Wall clock time in seconds, as clock() adds up the time of every thread
+double wallTime(){
+     struct timespec t;
+     timespec_get(&t, TIME_UTC);
+     return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+void benchDijkstraBatch(){
+     int v = 10000, e = 100000, count = 256;
+     network *n = randomNetwork(v, e);
+     item *roots = malloc(count * sizeof(item));
+     for(int i = 0; i < count; i++) { roots[i] = rand() % v; }
+     double *d = malloc((size_t)count * v * sizeof(double));
+     item *p = malloc((size_t)count * v * sizeof(item));
+     for(int threads = 1; threads <= 8; threads *= 2){
+          double start = wallTime();
+          dijkstraBatch(n, roots, count, d, p, threads);
+          printf("dijkstraBatch: %d roots, %d threads: %8.2f ms\n", count, threads, (wallTime() - start) * 1000);
+     }
+     free(roots); free(d); free(p);
+     freeNetwork(n);
+}
+
+void benchDeltaStepping(){
+     int v = 1000000, e = 10000000;
+     item *src = malloc(e * sizeof(item)), *dst = malloc(e * sizeof(item));
+     double *w = malloc(e * sizeof(double));
+     for(int i = 0; i < e; i++){
+          src[i] = rand() % v; dst[i] = rand() % v; w[i] = (rand() % 1000) / 100.0;
+     }
+     network *n = newNetworkFromEdges(src, dst, w, e, -1);
+     free(src); free(dst); free(w);
+     int size = nodes(n);
+     double *d = malloc(size * sizeof(double));
+     item *p = malloc(size * sizeof(item));
+
+     double start = wallTime();
+     dijkstraFrom(n, 0, d, p);
+     printf("dijkstraFrom: %7d nodes, %8d edges: %8.2f ms\n", size, e, (wallTime() - start) * 1000);
+     double deltas[] = {0, 1, 10};
+     for(int i = 0; i < 3; i++){
+          for(int threads = 1; threads <= 8; threads *= 2){
+               start = wallTime();
+               deltaStepping(n, 0, d, p, deltas[i], threads);
+               printf("deltaStepping: delta %4.1f, %d threads: %8.2f ms\n", deltas[i], threads, (wallTime() - start) * 1000);
+          }
+     }
+     free(d); free(p);
+     freeNetwork(n);
+}
+
+void benchShortestPath(){
+     int v = 100000, e = 1000000, queries = 100;
+     network *n = randomNetwork(v, e);
+     double *d = malloc(v * sizeof(double));
+     item *p = malloc(v * sizeof(item)), *path = malloc(v * sizeof(item));
+     int len;
+     for(int mode = 0; mode < 3; mode++){
+          srand(3);
+          double start = wallTime();
+          for(int i = 0; i < queries; i++){
+               item src = rand() % v, dst = rand() % v;
+               if(mode == 0) dijkstraFrom(n, src, d, p);
+               else if(mode == 1) shortestPath(n, src, dst, path, &len);
+               else bidirectionalPath(n, src, dst, path, &len);
+          }
+          char *names[] = {"dijkstraFrom", "shortestPath", "bidirectionalPath"};
+          printf("%s: %d point queries: %8.2f ms\n", names[mode], queries, (wallTime() - start) * 1000);
+     }
+     free(d); free(p); free(path);
+     freeNetwork(n);
+}
+
+void benchAstar(){
+     int width = 700, queries = 100;
+     network *n = gridNetwork(width);
+     int size = nodes(n);
+     item *path = malloc(size * sizeof(item));
+     int len;
+     for(int guided = 0; guided < 2; guided++){
+          srand(5);
+          double start = wallTime();
+          for(int i = 0; i < queries; i++){
+               item src = n->inventory[rand() % size]->x, dst = n->inventory[rand() % size]->x;
+               if(guided) astar(n, src, dst, gridSteps, &width, path, &len);
+               else shortestPath(n, src, dst, path, &len);
+          }
+          printf("%s: %d grid queries: %8.2f ms\n", guided ? "astar" : "shortestPath", queries,
+                 (wallTime() - start) * 1000);
+     }
+     free(path);
+     freeNetwork(n);
+}
+
+void benchCachedDijkstra(){
+     int v = 100000, e = 1000000, runs = 50;
+     network *n = randomNetwork(v, e);
+     double *d = malloc(v * sizeof(double));
+     item *p = malloc(v * sizeof(item));
+     const double *cachedD;
+     const item *cachedP;
+     for(int cached = 0; cached < 2; cached++){
+          double start = wallTime();
+          for(int i = 0; i < runs; i++){
+               if(cached) cachedDijkstra(n, i % 2, &cachedD, &cachedP);
+               else dijkstraFrom(n, i % 2, d, p);
+          }
+          printf("%s: %d runs over 2 roots: %8.2f ms\n", cached ? "cachedDijkstra" : "dijkstraFrom", runs,
+                 (wallTime() - start) * 1000);
+     }
+     free(d); free(p);
+     freeNetwork(n);
+}
+
+void benchTrackShortestPaths(){
+     int v = 100000, e = 1000000, updates = 50;
+     network *n = randomNetwork(v, e);
+     double *d = malloc(v * sizeof(double));
+     item *p = malloc(v * sizeof(item));
+     for(int tracked = 0; tracked < 2; tracked++){
+          if(tracked) trackShortestPaths(n, 0);
+          srand(7);
+          double start = wallTime();
+          for(int i = 0; i < updates; i++){
+               node *u = n->inventory[rand() % v];
+               n->current = u;
+               item y = rand() % v;
+               //Alternately add edges and make existing ones heavier
+               if(i % 2 == 0 || u->links == 0) link(n, y, (rand() % 1000) / 100.0);
+               else setWeight(n, n->inventory[u->edge[0].target]->x, 20);
+               if(!tracked) dijkstraFrom(n, 0, d, p);
+          }
+          printf("%s: %d edge updates: %8.2f ms\n", tracked ? "trackShortestPaths" : "dijkstraFrom", updates,
+                 (wallTime() - start) * 1000);
+     }
+     free(d); free(p);
+     freeNetwork(n);
+}
+
+void benchAllPairs(){
+     int v = 1200, e = 300000;
+     network *n = randomNetwork(v, e);
+     double *dist = malloc((size_t)v * v * sizeof(double));
+     item *next = malloc((size_t)v * v * sizeof(item));
+     item *roots = malloc(v * sizeof(item));
+     for(int i = 0; i < v; i++) { roots[i] = n->inventory[i]->x; }
+     double start = wallTime();
+     dijkstraBatch(n, roots, v, dist, next, 1);
+     printf("dijkstraBatch: %d roots, 1 thread: %8.2f ms\n", v, (wallTime() - start) * 1000);
+     for(int threads = 1; threads <= 4; threads *= 4){
+          start = wallTime();
+          allPairsShortest(n, dist, next, threads);
+          printf("allPairsShortest: %d nodes, %d threads: %8.2f ms\n", v, threads, (wallTime() - start) * 1000);
+     }
+     free(dist); free(next); free(roots);
+     freeNetwork(n);
+}
+
+void benchBulkLoad(){
+     int v = 500000, e = 5000000;
+     item *src = malloc(e * sizeof(item));
+     item *dst = malloc(e * sizeof(item));
+     double *w = malloc(e * sizeof(double));
+     for(int i = 0; i < e; i++){
+          src[i] = rand() % v; dst[i] = rand() % v; w[i] = (rand() % 1000) / 100.0;
+     }
+
+     clock_t start = clock();
+     network *n = newNetworkFromEdges(src, dst, w, e, -1);
+     double t = (double)(clock() - start) / CLOCKS_PER_SEC;
+     printf("newNetworkFromEdges: %7d nodes, %8d edges: %8.2f ms\n", nodes(n), e, t * 1000);
+     freeNetwork(n);
+
+     free(src); free(dst); free(w);
+}
+
+void benchStrongComponents(){
+     int v = 1000000, e = 5000000;
+     item *src = malloc(e * sizeof(item));
+     item *dst = malloc(e * sizeof(item));
+     for(int i = 0; i < e; i++) { src[i] = rand() % v; dst[i] = rand() % v; }
+     network *n = newNetworkFromEdges(src, dst, NULL, e, -1);
+     int *component = malloc(nodes(n) * sizeof(int));
+     double start = wallTime();
+     int count = strongComponents(n, component);
+     printf("strongComponents: %d nodes, %d edges, %d components: %8.2f ms\n", nodes(n), e, count,
+            (wallTime() - start) * 1000);
+     start = wallTime();
+     network *c = condense(n);
+     printf("condense: %8.2f ms\n", (wallTime() - start) * 1000);
+     freeNetwork(c);
+     freeNetwork(n);
+     free(src); free(dst); free(component);
+}
+
+void benchTopologicalOrder(){
+     int v = 1000000, e = 5000000;
+     item *src = malloc(e * sizeof(item));
+     item *dst = malloc(e * sizeof(item));
+     for(int i = 0; i < e; i++){
+          src[i] = rand() % (v - 1);
+          dst[i] = src[i] + 1 + rand() % (v - 1 - src[i]);
+     }
+     network *n = newNetworkFromEdges(src, dst, NULL, e, -1);
+     item *out = malloc(nodes(n) * sizeof(item));
+     int *levelStart = malloc((nodes(n) + 1) * sizeof(int));
+     double start = wallTime();
+     topologicalOrder(n, out);
+     printf("topologicalOrder: %d nodes, %d edges: %8.2f ms\n", nodes(n), e, (wallTime() - start) * 1000);
+     start = wallTime();
+     int levels = topologicalLevels(n, out, levelStart);
+     printf("topologicalLevels: %d levels: %8.2f ms\n", levels, (wallTime() - start) * 1000);
+     freeNetwork(n);
+     free(src); free(dst); free(out); free(levelStart);
+}
+
+void benchIsSubNet(){
+     int v = 1000000, e = 5000000;
+     item *src = malloc(e * sizeof(item));
+     item *dst = malloc(e * sizeof(item));
+     for(int i = 0; i < e; i++) { src[i] = rand() % v; dst[i] = rand() % v; }
+     network *n = newNetworkFromEdges(src, dst, NULL, e, -1);
+     //m has every edge of n, so every one is checked
+     network *m = newNetworkFromEdges(src, dst, NULL, e, -1);
+     double start = wallTime();
+     bool subnet = isSubNet(n, m);
+     printf("isSubNet: %d nodes, %d edges, %s: %8.2f ms\n", nodes(m), e, subnet ? "true" : "false",
+            (wallTime() - start) * 1000);
+     freeNetwork(n);
+     freeNetwork(m);
+     free(src); free(dst);
+}
+
+void benchFindSubNets(){
+     int v = 100000, e = 1000000;
+     network *host = randomNetwork(v, e);
+     char *names[] = {"3-cycle", "4-cycle with a chord"};
+     char *shapes[] = {"1-2,2-3,3-1", "1-2,2-3,3-4,4-1,1-3"};
+     for(int i = 0; i < 2; i++){
+          network *pattern = newNetworkFromString(shapes[i], -1);
+          double start = wallTime();
+          int count = findSubNets(host, pattern, 0, NULL, NULL);
+          printf("findSubNets: %s in %d edges, %d matches: %8.2f ms\n", names[i], e, count,
+                 (wallTime() - start) * 1000);
+          freeNetwork(pattern);
+     }
+     freeNetwork(host);
+}
+
+void benchDeleteNode(){
+     int sizes[] = {10000, 40000, 160000};
+     for(int k = 0; k < 3; k++){
+          //A hub with an edge to and from each of its leaves
+          int leaves = sizes[k];
+          network *n = newNetwork(-1);
+          addNode(n, 0);
+          for(int i = 1; i <= leaves; i++){
+               addNode(n, i); link(n, 0, 1);
+               n->current = find(n, 0); link(n, i, 1);
+          }
+          double start = wallTime();
+          for(int i = 1; i <= leaves; i += 2) { deleteNode(n, i); }
+          printf("deleteNode: half the leaves of a %6d hub: %8.2f ms\n", leaves, (wallTime() - start) * 1000);
+          freeNetwork(n);
+     }
+}
+
+void benchArena(){
+     int v = 100000, e = 1000000;
+     for(int arena = 0; arena < 2; arena++){
+          srand(2);
+          clock_t start = clock();
+          network *n = arena ? newNetworkArena(-1) : newNetwork(-1);
+          for(int i = 0; i < v; i++) { addNode(n, i); }
+          for(int i = 0; i < e; i++){
+               n->current = n->inventory[rand() % v];
+               link(n, rand() % v, 1);
+          }
+          freeNetwork(n);
+          double t = (double)(clock() - start) / CLOCKS_PER_SEC;
+          printf("%s: build and free %d nodes, %d edges: %8.2f ms\n",
+                    arena ? "newNetworkArena" : "newNetwork", v, e, t * 1000);
+     }
+}
+
+void bench(){
+     srand(1);
+     benchDijkstra();
+     benchDijkstraBatch();
+     benchDeltaStepping();
+     benchShortestPath();
+     benchAstar();
+     benchCachedDijkstra();
+     benchTrackShortestPaths();
+     benchAllPairs();
+     benchBulkLoad();
+     benchStrongComponents();
+     benchTopologicalOrder();
+     benchIsSubNet();
+     benchFindSubNets();
+     benchDeleteNode();
+     benchArena();
+}
+
 int main(int argC, char **argV){
      if(argC == 1) test();
+     else if(argC == 2 && strcmp(argV[1], "--bench") == 0) bench();
      else if(argC == 3 || argC == 2){
           item root = -1;
           if(argC == 3){ sscanf(argV[2], "%d", &root); }
@@ -1,5 +1,7 @@
 //Library references needed
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
 
 //Change type used here
 typedef int item;
@@ -8,11 +10,21 @@ typedef int item;
 struct network;
 typedef struct network network;
 
+//A read-only snapshot of a network - see freezeNetwork
+struct frozen;
+typedef struct frozen frozen;
+
 //Function delcarations
 
 //Creates a new, empty network with a defined default value
 network *newNetwork(item d);
 
+//Creates a new, empty network like newNetwork, whose nodes and edges are carved out of
+//large blocks of memory instead of being allocated one by one.
+//Memory is only given back when freeNetwork releases the blocks, so this suits networks that
+//are built, used and thrown away. Deleted nodes and outgrown edge lists stay until then.
+network *newNetworkArena(item d);
+
 //Creates a new network with null value d in the format specified by s
 //s is composed of a series of connections.
      //eg: 1-2,3-2,2-2/1.5
@@ -26,11 +38,30 @@ network *newNetwork(item d);
 //If x is not in the list, then a NULL pointer is returned.
 network *newNetworkFromString(char *s, item d);
 
+//Same as newNetworkFromString, but reads the first length characters of s, which need not end in 0.
+//Terms may also be separated by line breaks. The input is read in one pass with no allocation per term.
+//Nodes stay in the order they first appear instead of being sorted.
+//If a term is invalid, an error is printed and a NULL pointer is returned.
+network *newNetworkFromBuffer(const char *s, size_t length, item d);
+
+//Same as newNetworkFromBuffer, but reads the text from the file f in fixed-size chunks,
+//so the whole file never needs to be held in memory.
+network *newNetworkFromFile(FILE *f, item d);
+
+//Creates a new network with the given null value from m edges, where edge i goes from src[i]
+//to dst[i] with weight w[i]. If w is NULL, every edge has weight 1.
+//Nodes are created in the order they first appear, and the first is made the root and current node.
+//Repeated edges keep the first weight given. Edges with a null end or a negative weight are skipped.
+//Each node's edge array is sized exactly, so large networks are built without per-edge allocation.
+//If no nodes are created, a NULL pointer is returned.
+network *newNetworkFromEdges(const item *src, const item *dst, const double *w, size_t m, item null);
+
 //Creates a new node with an initial value
 //Sets the current node in the network to the new node
 bool addNode(network *n, item x);
 
 //Removes the node containing item x and any edges that point to it, then returns true
+//Nodes that had an edge to x may have their remaining edges reordered
 //If x is not in the network, false is returned
 bool deleteNode(network *n, item x);
 
@@ -94,6 +125,31 @@ bool unlink(network *n, item y);
 //If there are cycles in the network, true is returned
 bool isCyclic(network *n);
 
+//Gives every node a component number and returns the number of components
+//Two nodes are in the same component when each can be reached from the other, so every cycle
+//lies inside one component. component[i] is the number of the node at position i.
+//Components are numbered from 0 so that every edge between two of them goes to a higher number.
+//Runs in time proportional to the number of nodes and edges, without recursion.
+int strongComponents(const network *n, int *component);
+
+//Creates a new network with one node for each component of n, as numbered by strongComponents
+//There is an edge from one component to another if any node of the first has an edge to one of the
+//second, weighted by the lightest such edge. The result has no cycles. Its null value is -1, and
+//its root is the component of the root of n.
+network *condense(const network *n);
+
+//Writes the items of every node into out so that each node comes after all of the nodes with
+//edges to it, using Kahn's algorithm over the number of parents of each node.
+//out must have room for nodes(n) items. Returns nodes(n), or -1 if n has a cycle.
+int topologicalOrder(const network *n, item *out);
+
+//Same as topologicalOrder, with the nodes grouped into levels. Level 0 is every node with no parents,
+//and each other node is in the level after the deepest of its parents, so nodes in the same level
+//never depend on each other and can be handled at the same time.
+//Level k is out[levelStart[k]] to out[levelStart[k + 1] - 1]. levelStart must have room for nodes(n) + 1 entries.
+//Returns the number of levels, or -1 if n has a cycle.
+int topologicalLevels(const network *n, item *out, int *levelStart);
+
 //Returns true if the network is a tree.
 //Uses the node that n->root points to as the root node (should have 0 parents)
 //True is returned if:
@@ -112,12 +168,18 @@ int depth(network *n);
 //If goTo is set to true, the network then traverses to that node and returns true
 //If goTo is false, nothing will happen and it will simply return true
 //If the item cannot be found or the network is empty, nothing happens and false returns
-//The algorithm recursively checks each child of the root node until x is found, or not in the network
+//The search starts at the root node and follows each edge as deep as it goes before trying the next,
+//using a stack of nodes rather than recursion, until x is found or every reachable node has been checked
 bool depthFirstSearch(network *n, item x, bool goTo);
 //Same principle as depthFirstSearch, but a different algorithm is used
 //Checks every node at each depth before moving on to the next
 bool breadthFirstSearch(network *n, item x, bool goTo);
 
+//Writes the items of every node reachable from the root into out, in breadth-first order
+//out must have room for nodes(n) items
+//Returns the number of items written, which is 0 for an empty network
+int breadthFirstOrder(network *n, item *out);
+
 //Checks if the network m is a sub-network of network n.
 //m is a subnet if n contains all of the nodes in m,
 //and if each of those nodes point to all of the nodes that they do in m.
@@ -126,11 +188,58 @@ bool breadthFirstSearch(network *n, item x, bool goTo);
 //If either n or m are empty, false is returned automatically.
 bool isSubNet(network *n, network *m);
 
+//Finds every place the shape of pattern occurs in host, whatever the items of their nodes are.
+//A match gives each node of pattern a different node of host, so that wherever pattern has an
+//edge, host has an edge between the matching nodes. host may have other edges too, as in isSubNet.
+//For each match, found is called with match[i] being the host item matched to the node at position i
+//of pattern. If found returns false, or limit matches have been found, the search stops. A limit of 0
+//or less means no limit, and found may be NULL to only count matches.
+//Uses a VF2-style search without recursion - pattern nodes are matched most connected first, and
+//candidates are only taken from the edges of nodes already matched.
+//Returns the number of matches found. An empty pattern has none.
+int findSubNets(const network *host, const network *pattern, int limit,
+                bool (*found)(const item *match, void *ctx), void *ctx);
+
 //Calculates the shortest distance from the root node to every node in the network
 //If a node can't be traversed to from the root node, its distance is returned as -1
 //and its previous value is given as the null value of the network.
+//Results are kept as in cachedDijkstra, so running it again on an unchanged network only copies them.
 void dijkstra(network *n, double *d, item *p);
 
+//Points d and p at the results of dijkstraFrom for root, held inside n, and returns true
+//The results for the last few roots are kept until n is next changed, so asking for one of
+//them again takes no time. The arrays must not be written to, and stop being valid once n is
+//changed or more roots are asked for.
+//If root is not in n, d and p are set to NULL and false is returned.
+bool cachedDijkstra(network *n, item root, const double **d, const item **p);
+
+//Same as dijkstra, starting from item root instead of the root of the network
+//n is not changed, so several threads can run this on the same network at once.
+//If root is not in n, every distance is -1.
+void dijkstraFrom(const network *n, item root, double *d, item *p);
+
+//Runs dijkstraFrom for each of the count items in roots, spread over up to the given number of threads
+//d and p hold count rows of nodes(n) entries each - row k is the result for roots[k].
+//n must not be changed while this runs.
+void dijkstraBatch(const network *n, const item *roots, int count, double *d, item *p, int threads);
+
+//Same as dijkstraFrom, using delta stepping spread over up to the given number of threads
+//Nodes are put in buckets of width delta by distance. Edges no heavier than delta are relaxed
+//in parallel until a bucket stays empty, then the heavier ones once. A delta of 0 or less uses the
+//heaviest weight divided by the mean number of edges per node. Smaller widths mean less wasted
+//work but more, smaller steps. Widths below the heaviest weight divided by 65534 are raised to it.
+//d is the same as from dijkstraFrom. Where two paths are equally short, p may give either one.
+void deltaStepping(const network *n, item root, double *d, item *p, double delta, int threads);
+
+//Finds the shortest distance between every pair of nodes, using a Floyd-Warshall search split
+//into square tiles that fit in the cache, spread over up to the given number of threads.
+//dist holds nodes(n) rows of nodes(n) entries - entry i * nodes(n) + j is the distance from the
+//node at position i to the node at position j, or -1 if there is no path, as in dijkstra.
+//If next is not NULL, it is laid out the same way and given the item after the first on each path,
+//or the null value if there is no path. Following next from i leads along the path to j.
+//Takes time proportional to the cube of the number of nodes, so suits small, dense networks.
+void allPairsShortest(const network *n, double *dist, item *next, int threads);
+
 //Returns the numerical value of the shortest distance to item y.
 //If y is not in n, -1 is returned.
 double getShortestDistance(network *n, item y, double *d);
@@ -140,10 +249,82 @@ double getShortestDistance(network *n, item y, double *d);
 //If y is not in n, path is left unchanged.
 void getShortestPath(network *n, item y, item *p, item *path);
 
+//Finds the shortest path from src to dst and returns its length, or -1 if there isn't one
+//The search stops as soon as dst is reached, rather than finding the distance to every node.
+//The items on the path, from src to dst, are put in 'path', which must have room for every node,
+//and the number of them is put in len. If there is no path, len is 0.
+//n keeps the arrays the search uses for the next one, so a search costs only the part of n it reaches.
+double shortestPath(network *n, item src, item dst, item *path, int *len);
+
+//Same as shortestPath, searching forwards from src and backwards from dst at once
+//The two searches meet in the middle, so usually far fewer nodes are visited.
+double bidirectionalPath(network *n, item src, item dst, item *path, int *len);
+
+//Same as shortestPath, using A* search guided by the estimate h(x, dst, ctx) of the distance from x to dst
+//Nodes are taken in order of distance so far plus the estimate, so with a good estimate the search
+//heads towards dst and visits far fewer nodes. The estimate must never be more than the real distance,
+//or the path found may not be the shortest. If h is NULL, it is taken as 0 and this is the same as shortestPath.
+double astar(network *n, item src, item dst, double (*h)(item, item, void *), void *ctx, item *path, int *len);
+
+//Starts keeping the shortest paths from root up to date as n changes, and returns true
+//After this, link, unlink, setWeight, addNode, deleteNode and set only repair the part of
+//the paths that the change affects, instead of every path being found again.
+//Lower weights and new edges spread out from the edge, while higher weights and removed edges
+//only redo the nodes whose shortest paths used the edge.
+//Any paths already being kept for n are replaced. If root is not in n, false is returned.
+bool trackShortestPaths(network *n, item root);
+
+//Stops keeping shortest paths for n, if they were being kept
+void stopTracking(network *n);
+
+//Points d and p at the distances and previous items being kept for n, in the same form as
+//from dijkstra, and returns true. They are kept up to date and must not be written to.
+//If root is deleted, every node is left unreachable.
+//If trackShortestPaths has not been called, d and p are set to NULL and false is returned.
+bool trackedPaths(network *n, const double **d, const item **p);
+
 //Prints all of the information calculated by the running of dijkstra(n,d,p).
 //Includes the shortest distance as well as the full path from the root node.
 void printDijkstra(network *n, double *d, item *p);
 
+//Creates a frozen snapshot of n, with all edges stored in three contiguous arrays
+//(compressed sparse row form), for fast repeated read-only traversal.
+//Node i of the snapshot is the node at position i of n when it was frozen, so
+//d and p arrays from frozenDijkstra can be used with the functions above
+//for as long as n is not changed. Later changes to n do not affect the snapshot.
+frozen *freezeNetwork(network *n);
+
+void freeFrozen(frozen *f);
+
+//Returns the number of nodes in the snapshot
+int frozenNodes(frozen *f);
+
+//Returns the item held by node i of the snapshot
+//If i is out of range, the null value is returned
+item frozenItem(frozen *f, int i);
+
+//Same as depthFirstSearch and breadthFirstSearch, starting from the root of the snapshot
+bool frozenDepthFirstSearch(frozen *f, item x);
+bool frozenBreadthFirstSearch(frozen *f, item x);
+
+//Same as dijkstra, run on the snapshot
+void frozenDijkstra(frozen *f, double *d, item *p);
+
+//Same as isSubNet, with the snapshot f as the larger network
+bool frozenIsSubNet(frozen *f, network *m);
+
+//Writes n to the file at path in a compact binary form - the arrays of its frozen snapshot
+//Returns false if the file can't be written
+bool saveNetwork(network *n, const char *path);
+
+//Loads a file written by saveNetwork as a frozen snapshot
+//The file is mapped into memory and the snapshot reads it in place, with no parsing
+//and no allocation per node. freeFrozen releases the mapping.
+//Files are only readable by programs with the same item type and byte order.
+//Every array is checked once as it is loaded, so a damaged file can't make later searches read out of bounds.
+//If the file is missing or not in the right form, a NULL pointer is returned.
+frozen *loadNetwork(const char *path);
+
 //Prints the entire network in the form of an adjacency list
 //If the network is empty, nothing is printed
 void printList(network *n);